@@ -1,5 +1,8 @@
 import os
+import socket
+import struct
 import subprocess
+import threading
 import uuid
 import json
 from typing import List
@@ -14,18 +17,25 @@ COMPILER_DIR = os.path.join(BASE_DIR, "compiler_src")
 # 3. Definir dónde guardar el binario compilado
 TEMP_DIR = os.path.join(BASE_DIR, "temp")
 COMPILER_BIN = os.path.join(TEMP_DIR, "compiler.out")
+DAEMON_SOCKET = os.path.join(TEMP_DIR, "compiler.sock")
+CACHE_DIR = os.path.join(TEMP_DIR, "cache")
+# segundos que se espera al daemon por un pedido (conectar, mandar, respuesta)
+DAEMON_TIMEOUT = 60
 
 class CompilerService:
     def __init__(self):
         # prepara la carpeta temporal y compila el binario del compilador c++
         os.makedirs(TEMP_DIR, exist_ok=True)
         self.compile_cpp_compiler()
+        self.daemon = None
+        self.daemon_lock = threading.Lock()
+        self.start_daemon()
 
     def compile_cpp_compiler(self):
         """compila el compilador c++ una sola vez al iniciar el servidor"""
         sources = [
             os.path.join(COMPILER_DIR, f)
-            for f in ["main.cpp", "scanner.cpp", "parser.cpp", "ast.cpp", "visitor.cpp", "token.cpp", "TypeChecker.cpp"]
+            for f in ["main.cpp", "source_buffer.cpp", "scanner.cpp", "token_stream.cpp", "parser.cpp", "ast.cpp", "arena.cpp", "cache.cpp", "compi.cpp", "daemon.cpp", "diagnostics.cpp", "interner.cpp", "ir.cpp", "peephole.cpp", "regalloc.cpp", "session.cpp", "ssa.cpp", "thread_pool.cpp", "visitor.cpp", "x86_backend.cpp", "token.cpp", "TypeChecker.cpp"]
         ]
         def needs_recompile():
             if not os.path.exists(COMPILER_BIN):
@@ -39,22 +49,58 @@ class CompilerService:
 
         print("compilando el compilador c++...")
         
-        cmd = ["g++"] + sources + ["-o", COMPILER_BIN]
+        cmd = ["g++", "-std=c++17", "-pthread"] + sources + ["-o", COMPILER_BIN]
         res = subprocess.run(cmd, capture_output=True, text=True)
         
         if res.returncode != 0:
             raise RuntimeError(f"Error compilando el backend C++:\n{res.stderr}")
         print("compilador c++ listo.")
 
+    def start_daemon(self):
+        """levanta el compilador en modo servidor sobre un socket unix.
+        solo si no hay uno vivo: varios pedidos que fallan a la vez llaman aca
+        y no deben matarse el daemon entre ellos"""
+        with self.daemon_lock:
+            if self.daemon is not None and self.daemon.poll() is None:
+                return
+            self.daemon = subprocess.Popen([COMPILER_BIN, "--cache", CACHE_DIR, "--daemon", DAEMON_SOCKET],
+                                           stdout=subprocess.PIPE, text=True)
+            # la primera linea avisa que ya escucha
+            print(self.daemon.stdout.readline().strip())
+
+    def compile_remote(self, source_code: str):
+        """un pedido al daemon: devuelve (ok, asm, stack json, asm map json, diagnosticos)"""
+        def recv_exact(sock, n):
+            data = b""
+            while len(data) < n:
+                chunk = sock.recv(n - len(data))
+                if not chunk:
+                    raise ConnectionError("el compilador cerró la conexión")
+                data += chunk
+            return data
+
+        payload = source_code.encode()
+        with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+            sock.settimeout(DAEMON_TIMEOUT)
+            sock.connect(DAEMON_SOCKET)
+            sock.sendall(struct.pack("<II", len(payload) + 4, 0) + payload)
+            (size,) = struct.unpack("<I", recv_exact(sock, 4))
+            body = recv_exact(sock, size)
+
+        ok = body[4] == 1
+        pos = 5
+        fields = []
+        for _ in range(4):
+            (n,) = struct.unpack_from("<I", body, pos)
+            pos += 4
+            fields.append(body[pos:pos + n].decode())
+            pos += n
+        return (ok, *fields)
+
     def process_code(self, source_code: str):
         # usa un id unico para no mezclar ejecuciones concurrentes
         unique_id = str(uuid.uuid4())[:8]
-        input_path = os.path.join(TEMP_DIR, f"{unique_id}.txt")
-        #dot_path = os.path.join(TEMP_DIR, f"{unique_id}.dot")
-        #png_path = os.path.join(TEMP_DIR, f"{unique_id}.png")
-        asm_path = os.path.join(TEMP_DIR, f"{unique_id}.s")
         exec_path = os.path.join(TEMP_DIR, f"{unique_id}.exe")
-        stack_path = os.path.join(TEMP_DIR, f"{unique_id}_stack.json")
 
         logs = []
         output_text = ""
@@ -64,27 +110,32 @@ class CompilerService:
         asm_by_line = None
 
         try:
-            # 1. Guardar el código fuente del usuario
-            with open(input_path, "w") as f:
-                f.write(source_code)
-
             # -------------------------------------------------
-            # ejecutar el compilador c++ y generar el .s
-            res_asm = subprocess.run([COMPILER_BIN, input_path], capture_output=True, text=True)
-                
-            possible_asm = input_path.replace(".txt", ".s")
-            
-            # Si tu main.cpp fuerza la carpeta "inputs/", habrá que moverlo, 
-            # pero asumamos que lo genera relativo al input.
-            
-            if os.path.exists(possible_asm):
+            # compilar en el daemon: el fuente va y el asm, el stack y el mapa
+            # vuelven por el socket, sin archivos intermedios
+            try:
+                ok, asm_text, stack_json, asm_map_json, diagnostics = self.compile_remote(source_code)
+            except socket.timeout:
+                # el daemon sigue vivo pero no contestó: no se lo reinicia
+                raise RuntimeError(f"el compilador no respondió en {DAEMON_TIMEOUT} s")
+            except (ConnectionError, FileNotFoundError):
+                # el daemon se cayó: se levanta de nuevo y se reintenta una vez
+                self.start_daemon()
+                ok, asm_text, stack_json, asm_map_json, diagnostics = self.compile_remote(source_code)
+
+            if ok:
+                try:
+                    stack_frames = json.loads(stack_json)
+                except ValueError as e:
+                    logs.append(f"No se pudo leer stack JSON: {e}")
                 try:
-                    with open(possible_asm, "r") as asm_file:
-                        asm_text = asm_file.read()
-                except Exception as e:
-                    logs.append(f"No se pudo leer ASM: {e}")
+                    # mapa linea -> instrucciones asm generado por el visitor
+                    asm_by_line = json.loads(asm_map_json)
+                except ValueError as e:
+                    logs.append(f"No se pudo leer ASM map: {e}")
 
-                res_gcc = subprocess.run(["g++", possible_asm, "-o", exec_path], capture_output=True, text=True)
+                res_gcc = subprocess.run(["g++", "-x", "assembler", "-", "-o", exec_path],
+                                         input=asm_text, capture_output=True, text=True)
                 if res_gcc.returncode == 0:
                     res_exec = subprocess.run([exec_path], capture_output=True, text=True)
                     output_text = res_exec.stdout + res_exec.stderr
@@ -92,49 +143,16 @@ class CompilerService:
                     logs.append("Error GCC: " + res_gcc.stderr)
                     success = False
             else:
-                logs.append("No se generó archivo Assembly (.s).")
-                logs.append("Stdout del compilador: " + res_asm.stdout)
-                logs.append("Stderr del compilador: " + res_asm.stderr)
+                logs.append("No se generó Assembly.")
+                logs.append("Errores del compilador:\n" + diagnostics)
                 success = False
 
         except Exception as e:
             logs.append(f"Error interno del servidor: {str(e)}")
             success = False
-
-        # Intentar leer stack JSON si el compilador lo generó
-        if os.path.exists(stack_path):
-            try:
-                with open(stack_path, "r") as sf:
-                    stack_frames = json.load(sf)
-            except Exception as e:
-                logs.append(f"No se pudo leer stack JSON: {e}")
-
-        # mapa linea -> instrucciones asm generado por el visitor (si existe)
-        asm_map_path = stack_path + ".asm.json"
-        if os.path.exists(asm_map_path):
-            try:
-                with open(asm_map_path, "r") as am:
-                    asm_by_line = json.load(am)
-            except Exception as e:
-                logs.append(f"No se pudo leer ASM map: {e}")
-        elif asm_text:
-            # fallback usando SNAPIDX
-            asm_by_line = {}
-            current_line = None
-            for raw in asm_text.splitlines():
-                line = raw.strip("\n")
-                if line.startswith("# SNAPIDX"):
-                    parts = line.split("line")
-                    if len(parts) > 1:
-                        try:
-                            current_line = int(parts[-1].strip())
-                        except ValueError:
-                            current_line = None
-                    else:
-                        current_line = None
-                    continue
-                if current_line is not None:
-                    asm_by_line.setdefault(current_line, []).append(line)
+        finally:
+            if os.path.exists(exec_path):
+                os.remove(exec_path)
 
         return {
             "success": success,
@@ -1,6 +1,5 @@
 #include "TypeChecker.h"
-#include <cstdlib>
-#include <iostream>
+#include <atomic>
 #include <stdexcept>
 
 using namespace std;
@@ -9,12 +8,12 @@ using namespace std;
 //   Métodos accept específicos para el verificador de tipos
 // ===========================================================
 
-Type* NumberExp::accept(TypeVisitor* v) { return v->visit(this); }
-Type* IdExp::accept(TypeVisitor* v) { return v->visit(this); }
-Type* BinaryExp::accept(TypeVisitor* v) { return v->visit(this); }
-Type* FcallExp::accept(TypeVisitor* v) { return v->visit(this); }
-Type* BoolExp::accept(TypeVisitor* v) { return v->visit(this); }
-Type* TernaryExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* NumberExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* IdExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* BinaryExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* FcallExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* BoolExp::accept(TypeVisitor* v) { return v->visit(this); }
+const Type* TernaryExp::accept(TypeVisitor* v) { return v->visit(this); }
 
 void AssignStm::accept(TypeVisitor* v) { v->visit(this); }
 void PrintStm::accept(TypeVisitor* v) { v->visit(this); }
@@ -32,13 +31,13 @@ void Program::accept(TypeVisitor* v) { v->visit(this); }
 //   Constructor del TypeChecker
 // ===========================================================
 
-TypeChecker::TypeChecker() {
-    intType = new Type(Type::INT);
-    longType = new Type(Type::LONG);
-    floatType = new Type(Type::FLOAT);
-    voidType = new Type(Type::VOID);
-    uIntType = new Type(Type::UINT);
-    boolType = new Type(Type::BOOL);
+TypeChecker::TypeChecker(Diagnostics& d) : diags(&d) {
+    intType = Type::get(Type::INT);
+    longType = Type::get(Type::LONG);
+    floatType = Type::get(Type::FLOAT);
+    voidType = Type::get(Type::VOID);
+    uIntType = Type::get(Type::UINT);
+    boolType = Type::get(Type::BOOL);
     currentReturnType = nullptr;
 }
 
@@ -46,39 +45,33 @@ TypeChecker::TypeChecker() {
 //   Registrar funciones globales
 // ===========================================================
 
+void TypeChecker::error(const string& msg) {
+    diags->error("tipos", line, 0, msg);
+    throw CompileError(msg);
+}
+
 void TypeChecker::add_function(FunDec* fd) {
-    if (functions.find(fd->nombre) != functions.end()) {
-        cerr << "Error: función '" << fd->nombre << "' ya fue declarada." << endl;
-        exit(0);
+    line = fd->line;
+    if (functions->count(fd->nombre)) {
+        error("Error: función '" + fd->nombre + "' ya fue declarada.");
     }
 
-    Type* returnType = new Type();
-    if (!returnType->set_basic_type(fd->type)) {
-        cerr << "Error: tipo de retorno no válido en función '" << fd->nombre << "'." << endl;
-        exit(0);
+    const Type* returnType = Type::from_string(fd->type);
+    if (!returnType) {
+        error("Error: tipo de retorno no válido en función '" + fd->nombre + "'.");
     }
 
     FunctionInfo info;
     info.returnType = returnType;
     for (const auto& ptype : fd->Ptipos) {
-        Type* pt = new Type();
-        if (!pt->set_basic_type(ptype)) {
-            cerr << "Error: tipo de parámetro inválido en función '" << fd->nombre << "'." << endl;
-            exit(0);
+        const Type* pt = Type::from_string(ptype);
+        if (!pt) {
+            error("Error: tipo de parámetro inválido en función '" + fd->nombre + "'.");
         }
         info.paramTypes.push_back(pt);
     }
 
-    functions[fd->nombre] = info;
-}
-
-// ===========================================================
-//   Método principal de verificación
-// ===========================================================
-
-void TypeChecker::typecheck(Program* program) {
-    if (program) program->accept(this);
-    cout << "Revisión exitosa" << endl;
+    (*functions)[fd->nombre] = info;
 }
 
 // ===========================================================
@@ -86,15 +79,51 @@ void TypeChecker::typecheck(Program* program) {
 // ===========================================================
 
 void TypeChecker::visit(Program* p) {
+    beginProgram(p);
+    for (auto f : p->fdlist)
+        checkFunction(f);
+    endProgram();
+}
+
+void TypeChecker::beginProgram(Program* p) {
+    names = &p->names;
     // Primero registrar funciones
     for (auto f : p->fdlist)
         add_function(f);
 
     env.add_level();
     for (auto v : p->vdlist)
-        v->accept(this);  
-    for (auto f : p->fdlist)
-        f->accept(this);  
+        v->accept(this);
+}
+
+void TypeChecker::checkFunction(FunDec* f) {
+    f->accept(this);
+}
+
+size_t TypeChecker::checkFunctions(const vector<FunDec*>& fds, ThreadPool& pool) {
+    if (fds.empty()) return 0;
+    vector<TypeChecker> workers(pool.size(), *this);
+    vector<Diagnostics> discarded(pool.size());
+    atomic<size_t> firstError{fds.size()};
+    pool.parallelFor(fds.size(), [&](size_t i, unsigned w) {
+        if (i > firstError.load()) return; // ya hay un error antes en el orden
+        TypeChecker& tc = workers[w];
+        tc.diags = &discarded[w];
+        try {
+            tc.checkFunction(fds[i]);
+        } catch (const CompileError&) {
+            discarded[w].clear();
+            // el entorno quedó a medias: volver al ámbito global
+            tc.env = env;
+            tc.currentReturnType = nullptr;
+            size_t seen = firstError.load();
+            while (i < seen && !firstError.compare_exchange_weak(seen, i)) {}
+        }
+    });
+    return firstError.load();
+}
+
+void TypeChecker::endProgram() {
     env.remove_level();
 }
 
@@ -112,57 +141,53 @@ void TypeChecker::visit(Body* b) {
 // ===========================================================
 
 void TypeChecker::visit(VarDec* v) {
+    line = v->line;
     bool isAuto = (v->type == "auto" || v->kind == TYPE_AUTO);
 
     if (isAuto) {
-        Type* inferred = nullptr; // Tipo inferido por los inicializadores
+        const Type* inferred = nullptr; // Tipo inferido por los inicializadores
         size_t indice = 0; // Índice para inicializadores
         for (const auto& id : v->vars) { // se itera en cada variable
             if (indice >= v->initializers.size() || v->initializers[indice] == nullptr) { // si no tiene inicializador
-                cerr << "Error: 'auto' requiere inicializador para '" << id << "'." << endl; // error
-                exit(0);
+                error("Error: 'auto' requiere inicializador para '" + names->name(id) + "'."); // error
             }
-            Type* initType = v->initializers[indice]->accept(this); // obtener tipo del inicializador
+            const Type* initType = v->initializers[indice]->accept(this); // obtener tipo del inicializador
             if (!inferred) { // si es el primer inicializador
-                inferred = new Type(initType->ttype); // establecer tipo inferido
+                inferred = initType; // establecer tipo inferido
             } else if (!inferred->match(initType)) { // si no coincide con el tipo inferido
-                cerr << "Error: los inicializadores de 'auto' no coinciden en tipo." << endl;
-                exit(0);
+                error("Error: los inicializadores de 'auto' no coinciden en tipo.");
             }
 
             if (env.check(id)) {
-                cerr << "Error: variable '" << id << "' ya declarada." << endl;
-                exit(0);
+                error("Error: variable '" + names->name(id) + "' ya declarada.");
             }
-            env.add_var(id, new Type(inferred->ttype));
+            env.add_var(id, inferred);
             // Anotar el tipo inferido en el AST para uso posterior (gencode)
             v->type = Type::type_to_string(inferred->ttype);
             ++indice;
         }
     } else {
-        Type base;
-        if (!base.set_basic_type(v->type)) {
-            cerr << "Error: tipo de variable no válido." << endl;
-            exit(0);
+        const Type* base = Type::from_string(v->type);
+        if (!base) {
+            error("Error: tipo de variable no válido.");
         }
 
         size_t indice = 0;
         for (const auto& id : v->vars) {
             if (indice < v->initializers.size() && v->initializers[indice]) {
-                Type* initType = v->initializers[indice]->accept(this);
-                bool compatible = initType->match(&base) ||
-                                  (base.match(longType) && initType->match(intType)) ||
-                                  (base.match(uIntType) && (initType->match(intType) || initType->match(uIntType))) ||
-                                  (base.match(floatType) && (initType->match(intType) || initType->match(floatType)));
+                const Type* initType = v->initializers[indice]->accept(this);
+                bool compatible = initType->match(base) ||
+                                  (base->match(longType) && initType->match(intType)) ||
+                                  (base->match(uIntType) && (initType->match(intType) || initType->match(uIntType))) ||
+                                  (base->match(floatType) && (initType->match(intType) || initType->match(floatType)));
                 if (!compatible) {
-                    cerr << "Error: tipo de inicializador incompatible con '" << id << "'." << endl;
-                    exit(0);
+                    error("Error: tipo de inicializador incompatible con '" + names->name(id) + "'.");
                 }
             }
-            if (env.check(id)) {
-                env.update(id, new Type(base.ttype));
+            if (const Type** prev = env.find(id)) {
+                *prev = base;
             } else {
-                env.add_var(id, new Type(base.ttype));
+                env.add_var(id, base);
             }
             ++indice;
         }
@@ -170,31 +195,28 @@ void TypeChecker::visit(VarDec* v) {
 }
 
 void TypeChecker::visit(FunDec* f) {
+    line = f->line;
     env.add_level();
 
-    auto it = functions.find(f->nombre);
-    if (it == functions.end()) {
-        cerr << "Error interno: firma de función '" << f->nombre << "' no registrada." << endl;
-        exit(0);
+    auto it = functions->find(f->nombre);
+    if (it == functions->end()) {
+        error("Error interno: firma de función '" + f->nombre + "' no registrada.");
     }
 
     if (it->second.paramTypes.size() != f->Pnombres.size()) {
-        cerr << "Error: número de parámetros no coincide en función '" << f->nombre << "'." << endl;
-        exit(0);
+        error("Error: número de parámetros no coincide en función '" + f->nombre + "'.");
     }
 
     currentReturnType = it->second.returnType;
 
     for (size_t i = 0; i < f->Pnombres.size(); ++i) {
-        Type* pt = new Type();
-        if (!pt->set_basic_type(f->Ptipos[i])) {
-            cerr << "Error: tipo de parámetro inválido en función '" << f->nombre << "'." << endl;
-            exit(0);
+        const Type* pt = Type::from_string(f->Ptipos[i]);
+        if (!pt) {
+            error("Error: tipo de parámetro inválido en función '" + f->nombre + "'.");
         }
         if (!pt->match(it->second.paramTypes[i])) {
-            cerr << "Error: el tipo declarado del parámetro '" << f->Pnombres[i]
-                 << "' no coincide con la firma de la función." << endl;
-            exit(0);
+            error("Error: el tipo declarado del parámetro '" + names->name(f->Pnombres[i])
+                  + "' no coincide con la firma de la función.");
         }
         env.add_var(f->Pnombres[i], pt);
     }
@@ -208,67 +230,65 @@ void TypeChecker::visit(FunDec* f) {
 // ===========================================================
 
 void TypeChecker::visit(PrintStm* stm) {
-    Type* t = stm->e->accept(this);
+    line = stm->line;
+    const Type* t = stm->e->accept(this);
     if (!(t->match(intType) || t->match(boolType) || t->match(longType)
         || t->match(uIntType) || t->match(floatType))) {
-        cerr << "Error: tipo inválido en print." << endl;
-        exit(0);
+        error("Error: tipo inválido en print.");
     }
 }
 
 void TypeChecker::visit(AssignStm* stm) {
-    if (!env.check(stm->id)) {
-        cerr << "Error: variable '" << stm->id << "' no declarada." << endl;
-        exit(0);
+    line = stm->line;
+    const Type** found = env.find(stm->id);
+    if (!found) {
+        error("Error: variable '" + names->name(stm->id) + "' no declarada.");
     }
 
-    Type* varType = env.lookup(stm->id);
-    Type* expType = stm->e->accept(this);
+    const Type* varType = *found;
+    const Type* expType = stm->e->accept(this);
 
     if (varType->ttype == Type::AUTO) {
-        varType->ttype = expType->ttype;
+        env.update(stm->id, expType); // los tipos son inmutables: se reasigna el binding
     } else {
         bool compatible = varType->match(expType) ||
                           (varType->match(longType) && expType->match(intType)) ||
                           (varType->match(uIntType) && (expType->match(uIntType) || expType->match(intType))) ||
                           (varType->match(floatType) && (expType->match(floatType) || expType->match(intType)));
         if (!compatible) {
-            cerr << "Error: tipos incompatibles en asignación a '" << stm->id << "'." << endl;
-            exit(0);
+            error("Error: tipos incompatibles en asignación a '" + names->name(stm->id) + "'.");
         }
     }
 }
 
 void TypeChecker::visit(ReturnStm* stm) {
+    line = stm->line;
     if (!currentReturnType) {
-        cerr << "Error: 'return' fuera de una función." << endl;
-        exit(0);
+        error("Error: 'return' fuera de una función.");
     }
 
     if (stm->e == nullptr) {
         if (!currentReturnType->match(voidType)) {
-            cerr << "Error: la función espera un valor de retorno." << endl;
-            exit(0);
+            error("Error: la función espera un valor de retorno.");
         }
         return;
     }
 
-    Type* t = stm->e->accept(this);
+    const Type* t = stm->e->accept(this);
     if (!currentReturnType->match(t)) {
-        cerr << "Error: tipo de retorno incompatible con la función." << endl;
-        exit(0);
+        error("Error: tipo de retorno incompatible con la función.");
     }
 }
 
 // ...existing code...
 
 void TypeChecker::visit(IfStm* stm) {
+    line = stm->line;
     // Verificar que la condición sea booleana
     
-    Type* cond = stm->condition->accept(this);
+    const Type* cond = stm->condition->accept(this);
     if (!cond->match(boolType)) {
-        cerr << "Error: la condición del if debe ser booleana." << endl;
-        exit(0);
+        error("Error: la condición del if debe ser booleana.");
     }
 
     // --- OPTIMIZACIÓN: Si la condición es constante, solo procesar la rama ejecutable ---
@@ -304,24 +324,24 @@ void TypeChecker::visit(IfStm* stm) {
 }
 
 void TypeChecker::visit(WhileStm* stm) {
-    Type* cond = stm->condition->accept(this);
+    line = stm->line;
+    const Type* cond = stm->condition->accept(this);
     if (!cond->match(boolType)) {
-        cerr << "Error: la condición del while debe ser booleana." << endl;
-        exit(0);
+        error("Error: la condición del while debe ser booleana.");
     }
     stm->b->accept(this);
 }
 
 void TypeChecker::visit(ForStm* stm) {
+    line = stm->line;
     env.add_level();
 
     if (stm->init) stm->init->accept(this);
 
     if (stm->condition) {
-        Type* cond = stm->condition->accept(this);
+        const Type* cond = stm->condition->accept(this);
         if (!cond->match(boolType)) {
-            cerr << "Error: la condición del for debe ser booleana." << endl;
-            exit(0);
+            error("Error: la condición del for debe ser booleana.");
         }
     }
 
@@ -335,9 +355,9 @@ void TypeChecker::visit(ForStm* stm) {
 //   Expresiones
 // ===========================================================
 
-Type* TypeChecker::visit(BinaryExp* e) {
-    Type* left = e->left->accept(this);
-    Type* right = e->right->accept(this);
+const Type* TypeChecker::visit(BinaryExp* e) {
+    const Type* left = e->left->accept(this);
+    const Type* right = e->right->accept(this);
 
     bool leftIsUInt = left->match(uIntType);
     bool rightIsUInt = right->match(uIntType);
@@ -361,8 +381,7 @@ Type* TypeChecker::visit(BinaryExp* e) {
             if (leftIsUInt && rightIsUInt)   { e->inferredType = e->resultType = uIntType->ttype;  return uIntType; }
             if ((leftIsInt && rightIsUInt) || (leftIsUInt && rightIsInt)) { e->inferredType = e->resultType = intType->ttype; return intType; } // mezcla -> int
             if ((leftIsLong && rightIsUInt) || (leftIsUInt && rightIsLong)) { e->inferredType = e->resultType = longType->ttype; return longType; }
-            cerr << "Error: operacion aritmetica requiere tipos numericos compatibles." << endl;
-            exit(0);
+            error("Error: operacion aritmetica requiere tipos numericos compatibles.");
         case LE_OP:
             if (leftIsFloat || rightIsFloat) { e->inferredType = boolType->ttype; return boolType; }
             if ((leftIsInt && rightIsInt) ||
@@ -377,16 +396,14 @@ Type* TypeChecker::visit(BinaryExp* e) {
                 e->inferredType = e->resultType = boolType->ttype;
                 return boolType;
             }
-            cerr << "Error: comparacion requiere operandos numericos compatibles." << endl;
-            exit(0);
+            error("Error: comparacion requiere operandos numericos compatibles.");
         default:
-            cerr << "Error: operador binario no soportado." << endl;
-            exit(0);
+            error("Error: operador binario no soportado.");
     }
 }
 
-Type* TypeChecker::visit(NumberExp* e) {
-    Type* t = nullptr;
+const Type* TypeChecker::visit(NumberExp* e) {
+    const Type* t = nullptr;
     if (e->isFloat) t = floatType;
     else if (e->isUnsigned) t = uIntType;
     else t = e->isLong ? longType : intType;
@@ -395,36 +412,33 @@ Type* TypeChecker::visit(NumberExp* e) {
     return t;
 }
 
-Type* TypeChecker::visit(BoolExp* e) { e->inferredType = boolType->ttype; return boolType; }
+const Type* TypeChecker::visit(BoolExp* e) { e->inferredType = boolType->ttype; return boolType; }
 
-Type* TypeChecker::visit(IdExp* e) {
-    if (!env.check(e->value)) {
-        cerr << "Error: variable '" << e->value << "' no declarada." << endl;
-        exit(0);
+const Type* TypeChecker::visit(IdExp* e) {
+    const Type** found = env.find(e->value);
+    if (!found) {
+        error("Error: variable '" + names->name(e->value) + "' no declarada.");
     }
-    Type* t = env.lookup(e->value);
+    const Type* t = *found;
     e->inferredType = t->ttype;
     e->resolvedType = t->ttype;
     return t;
 }
 
-Type* TypeChecker::visit(FcallExp* e) {
-    auto it = functions.find(e->nombre);
-    if (it == functions.end()) {
-        cerr << "Error: llamada a función no declarada '" << e->nombre << "'." << endl;
-        exit(0);
+const Type* TypeChecker::visit(FcallExp* e) {
+    auto it = functions->find(e->nombre);
+    if (it == functions->end()) {
+        error("Error: llamada a función no declarada '" + e->nombre + "'.");
     }
 
     if (e->argumentos.size() != it->second.paramTypes.size()) {
-        cerr << "Error: cantidad de argumentos incorrecta en llamada a '" << e->nombre << "'." << endl;
-        exit(0);
+        error("Error: cantidad de argumentos incorrecta en llamada a '" + e->nombre + "'.");
     }
 
     for (size_t i = 0; i < e->argumentos.size(); ++i) {
-        Type* argType = e->argumentos[i]->accept(this);
+        const Type* argType = e->argumentos[i]->accept(this);
         if (!argType->match(it->second.paramTypes[i])) {
-            cerr << "Error: el argumento " << i << " de '" << e->nombre << "' no coincide con el tipo esperado." << endl;
-            exit(0);
+            error("Error: el argumento " + to_string(i) + " de '" + e->nombre + "' no coincide con el tipo esperado.");
         }
     }
 
@@ -433,19 +447,17 @@ Type* TypeChecker::visit(FcallExp* e) {
     return it->second.returnType;
 }
 
-Type* TypeChecker::visit(TernaryExp* e) {
-    Type* cond = e->condition->accept(this);
+const Type* TypeChecker::visit(TernaryExp* e) {
+    const Type* cond = e->condition->accept(this);
     if (!cond->match(boolType)) {
-        cerr << "Error: la condición del operador ternario debe ser booleana." << endl;
-        exit(0);
+        error("Error: la condición del operador ternario debe ser booleana.");
     }
 
-    Type* thenType = e->thenExp->accept(this);
-    Type* elseType = e->elseExp->accept(this);
+    const Type* thenType = e->thenExp->accept(this);
+    const Type* elseType = e->elseExp->accept(this);
 
     if (!thenType->match(elseType)) {
-        cerr << "Error: las ramas del operador ternario deben tener el mismo tipo." << endl;
-        exit(0);
+        error("Error: las ramas del operador ternario deben tener el mismo tipo.");
     }
 
     e->inferredType = thenType->ttype;
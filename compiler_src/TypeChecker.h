@@ -2,12 +2,15 @@
 #define TYPECHECKER_H
 // visitor de tipos que valida el ast antes de generar codigo
 
+#include <memory>
 #include <unordered_map>
 #include <string>
 #include <vector>
 #include "ast.h"
+#include "diagnostics.h"
 #include "environment.h"
 #include "semantic_types.h"
+#include "thread_pool.h"
 
 using namespace std;
 
@@ -47,13 +50,13 @@ public:
     virtual void visit(WhileStm* stm) = 0;
 
     // --- Expresiones ---
-    virtual Type* visit(BinaryExp* e) = 0;
-    virtual Type* visit(NumberExp* e) = 0;
-    virtual Type* visit(IdExp* e) = 0;
-    virtual Type* visit(BoolExp* e) = 0;
-    virtual Type* visit(FcallExp* e) = 0;
+    virtual const Type* visit(BinaryExp* e) = 0;
+    virtual const Type* visit(NumberExp* e) = 0;
+    virtual const Type* visit(IdExp* e) = 0;
+    virtual const Type* visit(BoolExp* e) = 0;
+    virtual const Type* visit(FcallExp* e) = 0;
     // NUEVA
-    virtual Type* visit(TernaryExp* e) = 0;
+    virtual const Type* visit(TernaryExp* e) = 0;
 };
 
 
@@ -65,32 +68,54 @@ public:
 class TypeChecker : public TypeVisitor {
 private:
     struct FunctionInfo {
-        Type* returnType;
-        vector<Type*> paramTypes;
+        const Type* returnType;
+        vector<const Type*> paramTypes;
     };
+    using FunctionTable = unordered_map<string, FunctionInfo>;
 
-    Environment<Type*> env;                        // Entorno de variables y sus tipos
-    unordered_map<string, FunctionInfo> functions; // Entorno de funciones
+    Environment<const Type*> env; // Entorno de variables y sus tipos
+    // Entorno de funciones: lo llena beginProgram y después solo se lee, así
+    // las copias de los hilos de checkFunctions lo comparten sin copiarlo
+    shared_ptr<FunctionTable> functions = make_shared<FunctionTable>();
 
     // Tipos básicos
-    Type* intType;
-    Type* longType;
-    Type* floatType;
-    Type* uIntType;
-    Type* voidType;
-    Type* boolType;
+    const Type* intType;
+    const Type* longType;
+    const Type* floatType;
+    const Type* uIntType;
+    const Type* voidType;
+    const Type* boolType;
 
     // Tipo de retorno de la función actual
-    Type* currentReturnType;
+    const Type* currentReturnType;
 
     // Registro de funciones
     void add_function(FunDec* fd);
 
+    // Errores: se registran en diags con la línea de la sentencia actual y
+    // se lanza CompileError para abandonar la verificación
+    Diagnostics* diags;
+    const Interner* names = nullptr; // del programa en verificacion, para los mensajes
+    int line = 0;
+    [[noreturn]] void error(const string& msg);
+
 public:
-    TypeChecker();
+    explicit TypeChecker(Diagnostics& diags);
     int locales;
-    // Método principal de verificación
-    void typecheck(Program* program);
+
+    // Verificación por partes para el driver por funciones: beginProgram
+    // registra firmas y revisa globales, checkFunction revisa un cuerpo ya
+    // parseado y endProgram cierra el ámbito global.
+    void beginProgram(Program* p);
+    void checkFunction(FunDec* f);
+    void endProgram();
+
+    // Verifica cuerpos ya parseados en paralelo. Cada hilo tiene su propio
+    // entorno (el ámbito global copiado) y tipo de retorno; las firmas se
+    // comparten porque no cambian después de beginProgram. Devuelve el índice de la primera función con error
+    // (fds.size() si no hay) sin registrar nada; volver a pasarla por
+    // checkFunction registra el error y lanza, igual que en secuencial.
+    size_t checkFunctions(const vector<FunDec*>& fds, ThreadPool& pool);
 
     // --- Visitas de alto nivel ---
     void visit(Program* p) override;
@@ -108,13 +133,13 @@ public:
     void visit(WhileStm* stm) override;
 
     // --- Expresiones ---
-    Type* visit(BinaryExp* e) override;
-    Type* visit(NumberExp* e) override;
-    Type* visit(IdExp* e) override;
-    Type* visit(FcallExp* e) override;
-    Type* visit(BoolExp* e) override;
+    const Type* visit(BinaryExp* e) override;
+    const Type* visit(NumberExp* e) override;
+    const Type* visit(IdExp* e) override;
+    const Type* visit(FcallExp* e) override;
+    const Type* visit(BoolExp* e) override;
     // NUEVA
-    Type* visit(TernaryExp* e) override;
+    const Type* visit(TernaryExp* e) override;
 };
 
 #endif // TYPECHECKER_H
\ No newline at end of file
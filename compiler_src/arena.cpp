@@ -0,0 +1,35 @@
+#include "arena.h"
+#include <cstdlib>
+
+Arena::Arena() : cur(nullptr), end(nullptr), used(0) {}
+
+Arena::~Arena() {
+    reset();
+}
+
+void* Arena::allocateSlow(size_t n, size_t align) {
+    // objetos grandes van en su propio bloque; el bloque actual sigue en uso
+    size_t size = (n + align > CHUNK_SIZE) ? n + align : CHUNK_SIZE;
+    char* chunk = static_cast<char*>(malloc(size));
+    if (!chunk) throw bad_alloc();
+    chunks.push_back(chunk);
+    char* p = chunk + (align - reinterpret_cast<size_t>(chunk) % align) % align;
+    if (size == CHUNK_SIZE) {
+        cur = p + n;
+        end = chunk + size;
+    }
+    used += n;
+    return p;
+}
+
+void Arena::reset() {
+    // destructores en orden inverso de construccion (hijos antes que padres)
+    for (size_t i = dtors.size(); i-- > 0;) {
+        dtors[i].fn(dtors[i].obj);
+    }
+    dtors.clear();
+    for (char* c : chunks) free(c);
+    chunks.clear();
+    cur = end = nullptr;
+    used = 0;
+}
@@ -0,0 +1,70 @@
+#ifndef ARENA_H
+#define ARENA_H
+// arena por compilacion: los nodos del ast se reservan contiguos en orden de
+// parseo y se liberan todos juntos al destruir el arena (un free por bloque).
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Tipos cuyo destructor no libera nada: el arena no lo registra ni lo llama.
+// Los nodos del ast que solo guardan punteros a otros nodos lo especializan.
+template <typename T>
+struct ArenaNoDtor : is_trivially_destructible<T> {};
+
+class Arena {
+private:
+    struct Dtor {
+        void (*fn)(void*);
+        void* obj;
+    };
+
+    static const size_t CHUNK_SIZE = 64 * 1024;
+
+    vector<char*> chunks;
+    char* cur;
+    char* end;
+    size_t used;
+    vector<Dtor> dtors; // solo nodos con miembros que liberan memoria (strings, vectores)
+
+    void* allocateSlow(size_t n, size_t align);
+
+public:
+    Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+
+    void* allocate(size_t n, size_t align) {
+        size_t pad = (align - reinterpret_cast<size_t>(cur) % align) % align;
+        if (cur && static_cast<size_t>(end - cur) >= n + pad) {
+            char* p = cur + pad;
+            cur = p + n;
+            used += n;
+            return p;
+        }
+        return allocateSlow(n, align);
+    }
+
+    // Construye un T dentro del arena; vive hasta reset() o el destructor del arena
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!ArenaNoDtor<T>::value) {
+            dtors.push_back(Dtor{[](void* o) { static_cast<T*>(o)->~T(); }, obj});
+        }
+        return obj;
+    }
+
+    // Destruye y libera todo lo reservado; el arena queda vacio y reutilizable
+    void reset();
+
+    size_t bytesUsed() const { return used; }
+    size_t chunkCount() const { return chunks.size(); }
+};
+
+#endif // ARENA_H
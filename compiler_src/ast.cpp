@@ -20,21 +20,19 @@ string Exp::binopToChar(BinaryOp op) {
 
 // ------------------ BinaryExp ------------------
 BinaryExp::BinaryExp(Exp* l, Exp* r, BinaryOp o)
-    : left(l), right(r), op(o) {}
+    : Exp(BINARY_EXP), left(l), right(r), op(o) {}
 
-BinaryExp::~BinaryExp() {
-    delete left;
-    delete right;
-}
+// los hijos viven en el arena del Program: los destructores no los liberan
+BinaryExp::~BinaryExp() {}
 
 // ------------------ NumberExp ------------------
 NumberExp::NumberExp(long long v, double fv, bool isFloatLiteral, bool isLongLiteral, bool isUnsignedLiteral)
-    : value(v), fvalue(fv), isFloat(isFloatLiteral), isLong(isLongLiteral), isUnsigned(isUnsignedLiteral) {}
+    : Exp(NUMBER_EXP), value(v), fvalue(fv), isFloat(isFloatLiteral), isLong(isLongLiteral), isUnsigned(isUnsignedLiteral) {}
 
 NumberExp::~NumberExp() {}
 
 // ------------------ IdExp ------------------
-IdExp::IdExp(string v) : value(move(v)) {}
+IdExp::IdExp(Symbol v) : Exp(ID_EXP), value(v) {}
 
 IdExp::~IdExp() {}
 
@@ -43,27 +41,23 @@ Stm::~Stm() {}
 
 // ------------------ PrintStm ------------------
 PrintStm::PrintStm(Exp* expresion, int lineNo)
-    : e(expresion) {
+    : Stm(PRINT_STM), e(expresion) {
     line = lineNo;
 }
 
-PrintStm::~PrintStm() {
-    delete e;
-}
+PrintStm::~PrintStm() {}
 
 // ------------------ AssignStm ------------------
-AssignStm::AssignStm(string variable, Exp* expresion, int lineNo)
-    : id(move(variable)), e(expresion) {
+AssignStm::AssignStm(Symbol variable, Exp* expresion, int lineNo)
+    : Stm(ASSIGN_STM), id(variable), e(expresion) {
     line = lineNo;
 }
 
-AssignStm::~AssignStm() {
-    delete e;
-}
+AssignStm::~AssignStm() {}
 
 // ------------------ IfStm ------------------
 IfStm::IfStm(Exp* c, Body* t, Body* e, int lineNo)
-    : condition(c), then(t), els(e) {
+    : Stm(IF_STM), condition(c), then(t), els(e) {
     line = lineNo;
 }
 
@@ -71,7 +65,7 @@ IfStm::IfStm(Exp* c, Body* t, Body* e, int lineNo)
 
 // ------------------ WhileStm ------------------
 WhileStm::WhileStm(Exp* c, Body* body, int lineNo)
-    : condition(c), b(body) {
+    : Stm(WHILE_STM), condition(c), b(body) {
     line = lineNo;
 }
 
@@ -79,39 +73,35 @@ WhileStm::WhileStm(Exp* c, Body* body, int lineNo)
 
 // ------------------ ForStm ------------------
 ForStm::ForStm(Stm* i, Exp* c, Stm* s, Body* body, int lineNo)
-    : init(i), condition(c), step(s), b(body) {
+    : Stm(FOR_STM), init(i), condition(c), step(s), b(body) {
     line = lineNo;
 }
 
 // ------------------ ReturnStm ------------------
-ReturnStm::ReturnStm() : e(nullptr) { line = 0; }
+ReturnStm::ReturnStm() : Stm(RETURN_STM), e(nullptr) { line = 0; }
 
-ReturnStm::ReturnStm(Exp* exp, int lineNo) : e(exp) { line = lineNo; }
+ReturnStm::ReturnStm(Exp* exp, int lineNo) : Stm(RETURN_STM), e(exp) { line = lineNo; }
 
 // destructor inline vacío en el .h
 
 // ------------------ FcallExp ------------------
-FcallExp::FcallExp() {}
+FcallExp::FcallExp() : Exp(FCALL_EXP) {}
 
 FcallExp::FcallExp(const string& n, const vector<Exp*>& args)
-    : nombre(n), argumentos(args) {}
+    : Exp(FCALL_EXP), nombre(n), argumentos(args) {}
 
 // destructor inline vacío en el .h
 
 // ------------------ TernaryExp ------------------
 TernaryExp::TernaryExp(Exp* c, Exp* t, Exp* e)
-    : condition(c), thenExp(t), elseExp(e) {}
+    : Exp(TERNARY_EXP), condition(c), thenExp(t), elseExp(e) {}
 
 // destructor inline vacío en el .h
 
 // ------------------ VarDec ------------------
 VarDec::VarDec(int lineNo) : line(lineNo) {}
 
-VarDec::~VarDec() {
-    for (Exp* init : initializers) {
-        delete init;
-    }
-}
+VarDec::~VarDec() {}
 
 // ------------------ Body ------------------
 Body::Body() {
@@ -119,31 +109,16 @@ Body::Body() {
     StmList      = list<Stm*>();
 }
 
-Body::~Body() {
-    for (Stm* s : StmList) {
-        delete s;
-    }
-    for (VarDec* v : declarations) {
-        delete v;
-    }
-}
+Body::~Body() {}
 
 // ------------------ FunDec ------------------
 FunDec::FunDec()
     : kind(TYPE_INT), type("int"), nombre(""), cuerpo(nullptr) {}
 
-FunDec::~FunDec() {
-    delete cuerpo;
-}
+FunDec::~FunDec() {}
 
 // ------------------ Program ------------------
 Program::Program() {}
 
-Program::~Program() {
-    for (VarDec* v : vdlist) {
-        delete v;
-    }
-    for (FunDec* f : fdlist) {
-        delete f;
-    }
-}
+// el arena libera todos los nodos de una vez al destruirse
+Program::~Program() {}
@@ -7,6 +7,8 @@
 #include <ostream>
 #include <vector>
 #include "semantic_types.h"
+#include "arena.h"
+#include "interner.h"
 
 using namespace std;
 
@@ -32,24 +34,52 @@ enum TypeKind {
     TYPE_AUTO,
 };
 
+// Etiqueta de cada nodo concreto: los pases de análisis despachan con un
+// switch sobre kind (ver ast_walk.h) en vez de probar dynamic_cast
+enum ExpKind {
+    BINARY_EXP,
+    NUMBER_EXP,
+    ID_EXP,
+    BOOL_EXP,
+    FCALL_EXP,
+    TERNARY_EXP
+};
+
+enum StmKind {
+    IF_STM,
+    WHILE_STM,
+    FOR_STM,
+    ASSIGN_STM,
+    PRINT_STM,
+    RETURN_STM
+};
+
 // Clase abstracta Exp
 class Exp {
 public:
     Type::TType inferredType = Type::NOTYPE; // tipo inferido tras el typecheck
+    const ExpKind kind;
+protected:
+    explicit Exp(ExpKind k) : kind(k) {}
 public:
     int cont;
     int valor;
+    // para el orden de evaluacion en codegen (sethi-ullman): temporales vivos
+    // a la vez que necesita el subarbol (0 sin calcular) y si hay llamadas
+    int registros = 0;
+    bool llamadas = false;
     virtual int  accept(Visitor* visitor) = 0;
     virtual ~Exp() = 0;  // Destructor puro → clase abstracta
     static string binopToChar(BinaryOp op);  // Conversión operador → string
 
     // --- NUEVO ---
-    virtual Type* accept(TypeVisitor* visitor) = 0; // Para verificador de tipos
+    virtual const Type* accept(TypeVisitor* visitor) = 0; // Para verificador de tipos
 };
 
 // Expresión binaria
 class BinaryExp : public Exp {
 public:
+    static const ExpKind KIND = BINARY_EXP;
     Exp* left;
     Exp* right;
     BinaryOp op;
@@ -58,12 +88,13 @@ public:
     BinaryExp(Exp* l, Exp* r, BinaryOp op);
     ~BinaryExp();
     // --- NUEVO ---
-    Type* accept(TypeVisitor* visitor);
+    const Type* accept(TypeVisitor* visitor);
 };
 
 // Expresión numérica
 class NumberExp : public Exp {
 public:
+    static const ExpKind KIND = NUMBER_EXP;
     long long value;
     double fvalue;
     bool isFloat;
@@ -74,34 +105,40 @@ public:
     NumberExp(long long v, double fv, bool isFloatLiteral, bool isLongLiteral, bool isUnsignedLiteral);
     ~NumberExp();
     // --- NUEVO ---
-    Type* accept(TypeVisitor* visitor);
+    const Type* accept(TypeVisitor* visitor);
 };
 
 // Expresión de identificador
 class IdExp : public Exp {
 public:
-    string value;
+    static const ExpKind KIND = ID_EXP;
+    Symbol value; // nombre internado (el texto esta en Program::names)
     Type::TType resolvedType = Type::NOTYPE;
     int accept(Visitor* visitor) override;
-    IdExp(string v);
+    IdExp(Symbol v);
     ~IdExp();
-    Type* accept(TypeVisitor* visitor);
+    const Type* accept(TypeVisitor* visitor);
 };
 
 class BoolExp : public Exp {
 public:
+    static const ExpKind KIND = BOOL_EXP;
     int valor;
 
-    BoolExp(){};
+    BoolExp() : Exp(BOOL_EXP) {};
     ~BoolExp(){};
 
     int accept(Visitor* visitor) override;
-    Type* accept(TypeVisitor* visitor) override;
+    const Type* accept(TypeVisitor* visitor) override;
 };
 
 class Stm{
 public:
     int line = 0;
+    const StmKind kind;
+protected:
+    explicit Stm(StmKind k) : kind(k) {}
+public:
     virtual int accept(Visitor* visitor) = 0;
     virtual ~Stm() = 0;
     virtual void accept(TypeVisitor* visitor) = 0;
@@ -111,7 +148,7 @@ class VarDec{
 public:
     TypeKind kind;
     string type;
-    list<string> vars;
+    list<Symbol> vars;
     vector<Exp*> initializers; // para soportar int x = 1;
     int line = 0;
     VarDec(int line = 0);
@@ -132,6 +169,7 @@ public:
 
 class IfStm: public Stm {
 public:
+    static const StmKind KIND = IF_STM;
     Exp* condition;
     Body* then;
     Body* els; // puede ser nullptr
@@ -144,6 +182,7 @@ public:
 
 class WhileStm: public Stm {
 public:
+    static const StmKind KIND = WHILE_STM;
     Exp* condition;
     Body* b;
 
@@ -155,6 +194,7 @@ public:
 
 class ForStm: public Stm {
 public:
+    static const StmKind KIND = FOR_STM;
     Stm*  init;      // sentencia de inicialización (ej. i = 0;)
     Exp*  condition; // condición del for (ej. i < 10)
     Stm*  step;      // sentencia de incremento (ej. i = i + 1;)
@@ -168,10 +208,11 @@ public:
 
 class AssignStm: public Stm {
 public:
-    string id;
+    static const StmKind KIND = ASSIGN_STM;
+    Symbol id;
     Exp* e;
 
-    AssignStm(string, Exp*, int line = 0);
+    AssignStm(Symbol, Exp*, int line = 0);
     ~AssignStm();
     int accept(Visitor* visitor) override;
     void accept(TypeVisitor* visitor) override;
@@ -179,6 +220,7 @@ public:
 
 class PrintStm: public Stm {
 public:
+    static const StmKind KIND = PRINT_STM;
     Exp* e;
 
     PrintStm(Exp*, int line = 0);
@@ -189,6 +231,7 @@ public:
 
 class ReturnStm: public Stm {
 public:
+    static const StmKind KIND = RETURN_STM;
     Exp* e; // puede ser nullptr
 
     ReturnStm();
@@ -200,6 +243,7 @@ public:
 
 class FcallExp: public Exp {
 public:
+    static const ExpKind KIND = FCALL_EXP;
     string nombre;
     vector<Exp*> argumentos;
     Type::TType returnType = Type::NOTYPE;
@@ -208,7 +252,7 @@ public:
     FcallExp();
     FcallExp(const string& nombre, const vector<Exp*>& args);
     ~FcallExp(){};
-    Type* accept(TypeVisitor* visitor) override;
+    const Type* accept(TypeVisitor* visitor) override;
 };
 
 class FunDec{
@@ -218,7 +262,12 @@ public:
     string nombre;
     Body* cuerpo;
     vector<string> Ptipos;
-    vector<string> Pnombres;
+    vector<Symbol> Pnombres;
+    int line = 0;
+    // cuerpo diferido: tokens [bodyBegin, bodyEnd) del TokenStream, de '{' a '}'.
+    // mientras cuerpo == nullptr el Parser lo puede construir bajo demanda.
+    size_t bodyBegin = 0;
+    size_t bodyEnd = 0;
 
     int accept(Visitor* visitor);
     FunDec();
@@ -228,6 +277,8 @@ public:
 
 class Program{
 public:
+    Arena arena;    // dueño de todos los nodos del ast de esta compilacion
+    Interner names; // identificadores de esta compilacion (ver interner.h)
     list<VarDec*> vdlist;
     list<FunDec*> fdlist;
 
@@ -239,6 +290,7 @@ public:
 
 class TernaryExp : public Exp {
 public:
+    static const ExpKind KIND = TERNARY_EXP;
     Exp* condition;
     Exp* thenExp;
     Exp* elseExp;
@@ -247,7 +299,28 @@ public:
     TernaryExp(Exp* condition, Exp* thenExp, Exp* elseExp);
     int accept(Visitor* visitor) override;
     ~TernaryExp(){};
-    Type* accept(TypeVisitor* visitor);
+    const Type* accept(TypeVisitor* visitor);
 };
 
+// Downcast por etiqueta: nullptr si el nodo no es un T
+template <typename T> T* nodeAs(Exp* e) {
+    return e && e->kind == T::KIND ? static_cast<T*>(e) : nullptr;
+}
+template <typename T> T* nodeAs(Stm* s) {
+    return s && s->kind == T::KIND ? static_cast<T*>(s) : nullptr;
+}
+
+// Nodos que solo guardan punteros a otros nodos: el arena no llama su destructor
+template <> struct ArenaNoDtor<BinaryExp>  : true_type {};
+template <> struct ArenaNoDtor<NumberExp>  : true_type {};
+template <> struct ArenaNoDtor<IdExp>      : true_type {};
+template <> struct ArenaNoDtor<BoolExp>    : true_type {};
+template <> struct ArenaNoDtor<TernaryExp> : true_type {};
+template <> struct ArenaNoDtor<IfStm>      : true_type {};
+template <> struct ArenaNoDtor<WhileStm>   : true_type {};
+template <> struct ArenaNoDtor<ForStm>     : true_type {};
+template <> struct ArenaNoDtor<PrintStm>   : true_type {};
+template <> struct ArenaNoDtor<AssignStm>  : true_type {};
+template <> struct ArenaNoDtor<ReturnStm>  : true_type {};
+
 #endif // AST_H
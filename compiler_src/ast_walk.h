@@ -0,0 +1,93 @@
+#ifndef AST_WALK_H
+#define AST_WALK_H
+
+#include "ast.h"
+
+using namespace std;
+
+// recorrido generico del ast para pases de analisis. despacha con un switch
+// sobre la etiqueta kind de cada nodo (sin dynamic_cast ni llamadas
+// virtuales) y llama a Derived::visit del tipo concreto (CRTP).
+// los visit por defecto solo bajan a los hijos en orden de fuente; Derived
+// redefine los que le interesan y agrega 'using AstWalker<Derived>::visit;'
+// para no ocultar el resto.
+
+template <typename Derived>
+class AstWalker {
+    Derived& self() { return static_cast<Derived&>(*this); }
+
+public:
+    void walk(Body* b) {
+        if (b) self().visit(b);
+    }
+
+    void walk(Stm* s) {
+        if (!s) return;
+        switch (s->kind) {
+            case IF_STM:     self().visit(static_cast<IfStm*>(s)); break;
+            case WHILE_STM:  self().visit(static_cast<WhileStm*>(s)); break;
+            case FOR_STM:    self().visit(static_cast<ForStm*>(s)); break;
+            case ASSIGN_STM: self().visit(static_cast<AssignStm*>(s)); break;
+            case PRINT_STM:  self().visit(static_cast<PrintStm*>(s)); break;
+            case RETURN_STM: self().visit(static_cast<ReturnStm*>(s)); break;
+        }
+    }
+
+    void walk(Exp* e) {
+        if (!e) return;
+        switch (e->kind) {
+            case BINARY_EXP:  self().visit(static_cast<BinaryExp*>(e)); break;
+            case NUMBER_EXP:  self().visit(static_cast<NumberExp*>(e)); break;
+            case ID_EXP:      self().visit(static_cast<IdExp*>(e)); break;
+            case BOOL_EXP:    self().visit(static_cast<BoolExp*>(e)); break;
+            case FCALL_EXP:   self().visit(static_cast<FcallExp*>(e)); break;
+            case TERNARY_EXP: self().visit(static_cast<TernaryExp*>(e)); break;
+        }
+    }
+
+    // --- por defecto: recorrer los hijos ---
+    void visit(Body* b) {
+        for (VarDec* vd : b->declarations) self().visit(vd);
+        for (Stm* s : b->StmList) walk(s);
+    }
+    void visit(VarDec* vd) {
+        for (Exp* init : vd->initializers) walk(init);
+    }
+
+    void visit(IfStm* s) {
+        walk(s->condition);
+        walk(s->then);
+        walk(s->els);
+    }
+    void visit(WhileStm* s) {
+        walk(s->condition);
+        walk(s->b);
+    }
+    void visit(ForStm* s) {
+        walk(s->init);
+        walk(s->condition);
+        walk(s->step);
+        walk(s->b);
+    }
+    void visit(AssignStm* s) { walk(s->e); }
+    void visit(PrintStm* s)  { walk(s->e); }
+    void visit(ReturnStm* s) { walk(s->e); }
+
+    void visit(BinaryExp* e) {
+        walk(e->left);
+        walk(e->right);
+    }
+    void visit(TernaryExp* e) {
+        walk(e->condition);
+        walk(e->thenExp);
+        walk(e->elseExp);
+    }
+    void visit(FcallExp* e) {
+        for (Exp* arg : e->argumentos) walk(arg);
+    }
+    void visit(NumberExp*) {}
+    void visit(IdExp*) {}
+    void visit(BoolExp*) {}
+};
+
+#endif // AST_WALK_H
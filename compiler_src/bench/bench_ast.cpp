@@ -0,0 +1,80 @@
+// benchmark sobre un ast grande: parseo completo a la arena y pasadas de
+// analisis con AstWalker (despacho por kind), la misma forma de recorrido
+// que usa el visitor para juntar las variables leidas de cada funcion.
+//
+// uso: bench_ast [archivo]   (sin archivo: programa sintetico de 16 MB)
+
+#include <iostream>
+#include <memory>
+#include <unordered_set>
+#include "ast_walk.h"
+#include "bench_util.h"
+#include "diagnostics.h"
+#include "parser.h"
+#include "token_stream.h"
+
+using namespace std;
+
+struct ContadorNodos : AstWalker<ContadorNodos> {
+    using AstWalker<ContadorNodos>::visit;
+    size_t exps = 0, stms = 0;
+    void visit(IdExp*) { ++exps; }
+    void visit(NumberExp*) { ++exps; }
+    void visit(BinaryExp* e) {
+        ++exps;
+        AstWalker<ContadorNodos>::visit(e);
+    }
+    void visit(AssignStm* s) {
+        ++stms;
+        AstWalker<ContadorNodos>::visit(s);
+    }
+};
+
+struct VariablesLeidas : AstWalker<VariablesLeidas> {
+    using AstWalker<VariablesLeidas>::visit;
+    unordered_set<Symbol>& usadas;
+    void visit(IdExp* e) { usadas.insert(e->value); }
+};
+
+int main(int argc, char* argv[]) {
+    string src = entradaBench(argc, argv, 16u << 20);
+    TokenStream ts = tokenizeAll(src);
+
+    unique_ptr<Program> prog;
+    double msParseo = mejorDe(3, [&] {
+        Diagnostics diags;
+        Parser parser(&ts, diags);
+        try {
+            prog.reset(parser.parseProgram());
+        } catch (const CompileError&) {
+            cerr << diags.render();
+            exit(1);
+        }
+    });
+
+    ContadorNodos contador;
+    for (FunDec* f : prog->fdlist) contador.walk(f->cuerpo);
+
+    const int pasadas = 20;
+    size_t total = 0;
+    double msConteo = mejorDe(pasadas, [&] {
+        ContadorNodos c;
+        for (FunDec* f : prog->fdlist) c.walk(f->cuerpo);
+        total += c.exps;
+    });
+    double msUsadas = mejorDe(pasadas, [&] {
+        for (FunDec* f : prog->fdlist) {
+            unordered_set<Symbol> usadas;
+            VariablesLeidas{{}, usadas}.walk(f->cuerpo);
+            total += usadas.size();
+        }
+    });
+    noDescartar(total);
+
+    cout << "entrada: " << src.size() / 1e6 << " MB, " << prog->fdlist.size() << " funciones, "
+         << contador.stms << " asignaciones, " << contador.exps << " expresiones" << endl;
+    cout << "parseo:            " << msParseo << " ms" << endl;
+    cout << "conteo de nodos:   " << msConteo << " ms/pasada" << endl;
+    cout << "variables leidas:  " << msUsadas << " ms/pasada" << endl;
+    return 0;
+}
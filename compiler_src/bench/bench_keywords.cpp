@@ -0,0 +1,65 @@
+// micro-benchmark de la clasificacion de identificadores del scanner:
+// keywords::lookup (tabla con hash perfecto) contra la cadena de
+// comparaciones sobre un string temporal que usaba el scanner antes, con
+// una mezcla de palabras clave e identificadores comunes.
+//
+// uso: bench_keywords [cantidad de lexemas]   (por defecto 2 millones)
+
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "bench_util.h"
+#include "keywords.h"
+
+using namespace std;
+
+// la clasificacion anterior: un substr y hasta catorce comparaciones
+static Token::Type cadenaDeComparaciones(const string& input, int first, int cur) {
+    string lex = input.substr(first, cur - first);
+    if (lex == "return") return Token::RETURN;
+    if (lex == "if") return Token::IF;
+    if (lex == "else") return Token::ELSE;
+    if (lex == "while") return Token::WHILE;
+    if (lex == "for") return Token::FOR;
+    if (lex == "do") return Token::DO;
+    if (lex == "printf") return Token::PRINT;
+    if (lex == "true") return Token::TRUE;
+    if (lex == "false") return Token::FALSE;
+    if (lex == "unsigned") return Token::UNSIGNED;
+    if (lex == "int") return Token::INT;
+    if (lex == "float") return Token::FLOAT;
+    if (lex == "long") return Token::LONG;
+    if (lex == "auto") return Token::AUTO;
+    return Token::ID;
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+    const char* palabras[] = {"counter_value", "int", "x", "return", "accumulatorTotal", "while",
+                              "i", "for", "long", "someIdentifierName", "printf", "auto"};
+    string src;
+    vector<pair<int, int>> lexemas;
+    for (size_t i = 0; i < n; ++i) {
+        int first = (int)src.size();
+        src += palabras[i % 12];
+        lexemas.push_back({first, (int)src.size()});
+        src += ' ';
+    }
+
+    long suma = 0;
+    double msCadena = mejorDe(5, [&] {
+        for (auto& l : lexemas) suma += cadenaDeComparaciones(src, l.first, l.second);
+    });
+    string_view vista(src);
+    double msTabla = mejorDe(5, [&] {
+        for (auto& l : lexemas) suma += keywords::lookup(vista.substr(l.first, l.second - l.first));
+    });
+    noDescartar(suma);
+
+    cout << n << " lexemas" << endl;
+    cout << "comparaciones: " << msCadena << " ms, " << msCadena * 1e6 / n << " ns/lexema" << endl;
+    cout << "tabla:         " << msTabla << " ms, " << msTabla * 1e6 / n << " ns/lexema" << endl;
+    cout << "aceleracion:   " << msCadena / msTabla << "x" << endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+// throughput del analisis lexico en MB/s: el Scanner token a token (lo que
+// usa el parser en modo directo), el Scanner guardando cada token (lo que
+// haria falta para tener el lote entero) y tokenizeAll, que llena el
+// TokenStream de una vez.
+//
+// uso: bench_scanner [archivo]   (sin archivo: programa sintetico de 32 MB)
+
+#include <iostream>
+#include <vector>
+#include "bench_util.h"
+#include "scanner.h"
+#include "token_stream.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    string src = entradaBench(argc, argv, 32u << 20);
+    double mb = src.size() / 1e6;
+
+    size_t tokens = 0;
+    double msScanner = mejorDe(5, [&] {
+        Scanner sc(src);
+        tokens = 0;
+        while (sc.nextToken().type != Token::END) ++tokens;
+    });
+    double msVector = mejorDe(5, [&] {
+        Scanner sc(src);
+        vector<Token> v;
+        v.reserve(src.size() / 4 + 1);
+        do {
+            v.push_back(sc.nextToken());
+        } while (v.back().type != Token::END);
+        noDescartar(v);
+    });
+    double msStream = mejorDe(5, [&] {
+        TokenStream ts = tokenizeAll(src);
+        noDescartar(ts.size());
+    });
+
+    cout << "entrada: " << mb << " MB, " << tokens << " tokens" << endl;
+    cout << "scanner:         " << msScanner << " ms, " << mb / (msScanner / 1e3) << " MB/s" << endl;
+    cout << "scanner+vector:  " << msVector << " ms, " << mb / (msVector / 1e3) << " MB/s" << endl;
+    cout << "tokenizeAll:     " << msStream << " ms, " << mb / (msStream / 1e3) << " MB/s" << endl;
+    return 0;
+}
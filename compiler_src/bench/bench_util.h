@@ -0,0 +1,77 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+// utilidades comunes de los benchmarks: la entrada (un archivo dado o un
+// programa sintetico del tamaño pedido) y la medicion (mejor de n corridas).
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+// una funcion tipica del lenguaje (comentarios, declaraciones, bucles,
+// expresiones) repetida con nombres distintos hasta pasar bytes, y un main
+inline string programaSintetico(size_t bytes) {
+    string src;
+    int n = 0;
+    while (src.size() < bytes) {
+        string f = "f" + to_string(n++);
+        src += "// " + f + ": acumula y recorta\n"
+               "int " + f + "(int a, int b) {\n"
+               "    int x;\n"
+               "    int total;\n"
+               "    long grande;\n"
+               "    total = 0;\n"
+               "    grande = 1234567;\n"
+               "    for (int i = 0; i < a; i++) {\n"
+               "        x = (a * i + b) / 3 - 17;\n"
+               "        if (x < total) {\n"
+               "            total = total + x * 2;\n"
+               "        } else {\n"
+               "            total = total - 1;\n"
+               "        }\n"
+               "    }\n"
+               "    while (b < 100) {\n"
+               "        b = b + a * 2 + (total < 0 ? 1 : 2);\n"
+               "    }\n"
+               "    grande = grande + total;\n"
+               "    printf(\"%ld\\n\", grande);\n"
+               "    return total + b;\n"
+               "}\n\n";
+    }
+    src += "int main() {\n    printf(\"%d\\n\", f0(3, 4));\n    return 0;\n}\n";
+    return src;
+}
+
+// el archivo de argv[1] si se dio, si no un programa sintetico de bytes
+inline string entradaBench(int argc, char* argv[], size_t bytes) {
+    if (argc > 1) {
+        ifstream in(argv[1], ios::binary);
+        stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+    return programaSintetico(bytes);
+}
+
+// milisegundos de la corrida mas rapida de fn entre reps
+template <class F>
+double mejorDe(int reps, F fn) {
+    double mejor = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        if (ms < mejor) mejor = ms;
+    }
+    return mejor;
+}
+
+// evita que el optimizador descarte un resultado que nadie usa
+template <class T>
+inline void noDescartar(const T& v) {
+    asm volatile("" : : "g"(&v) : "memory");
+}
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,223 @@
+#include "cache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <vector>
+#include "compi.h"
+#include "hash64.h"
+#include "source_buffer.h"
+
+using namespace std;
+
+static const char* CACHE_MAGIC = "compi-cache 1\n";
+
+namespace {
+
+uint64_t contentKey(const string& normalized) {
+    Hash64 h;
+    h.add(CACHE_MAGIC);
+    h.add(compilerIdentity());
+    h.add(normalized);
+    return h.h;
+}
+
+bool isEntryName(const char* name) {
+    size_t n = strlen(name);
+    if (n != 16) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (!isxdigit((unsigned char)name[i])) return false;
+    }
+    return true;
+}
+
+bool writeFile(const string& path, const string& data) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+void putStr(string& buf, string_view s) {
+    uint64_t n = s.size();
+    buf.append(reinterpret_cast<const char*>(&n), sizeof n);
+    buf.append(s.data(), s.size());
+}
+
+bool getStr(string_view& in, string_view& s) {
+    uint64_t n;
+    if (in.size() < sizeof n) return false;
+    memcpy(&n, in.data(), sizeof n);
+    in.remove_prefix(sizeof n);
+    if (in.size() < n) return false;
+    s = in.substr(0, n);
+    in.remove_prefix(n);
+    return true;
+}
+
+} // namespace
+
+ArtifactCache::ArtifactCache(string dir, uint64_t maxBytes) : dir(std::move(dir)), maxBytes(maxBytes) {
+    mkdir(this->dir.c_str(), 0755);
+}
+
+string ArtifactCache::normalize(string_view source) {
+    string out;
+    out.reserve(source.size());
+    size_t start = 0;
+    while (start < source.size()) {
+        size_t nl = source.find('\n', start);
+        size_t end = nl == string_view::npos ? source.size() : nl;
+        size_t trimmed = end;
+        while (trimmed > start && (source[trimmed - 1] == ' ' || source[trimmed - 1] == '\t' ||
+                                   source[trimmed - 1] == '\r')) {
+            --trimmed;
+        }
+        out.append(source.substr(start, trimmed - start));
+        if (nl == string_view::npos) break;
+        out += '\n';
+        start = nl + 1;
+    }
+    return out;
+}
+
+string ArtifactCache::entryPath(uint64_t key) const {
+    char name[17];
+    snprintf(name, sizeof name, "%016llx", (unsigned long long)key);
+    return dir + "/" + name;
+}
+
+CacheStats ArtifactCache::updateStats(const function<void(CacheStats&)>& update) const {
+    CacheStats stats;
+    int fd = open((dir + "/stats").c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return stats;
+    flock(fd, LOCK_EX);
+    char buf[160];
+    ssize_t n = pread(fd, buf, sizeof buf - 1, 0);
+    if (n > 0) {
+        buf[n] = '\0';
+        unsigned long long h, m, s, e, b;
+        if (sscanf(buf, "%llu %llu %llu %llu %llu", &h, &m, &s, &e, &b) == 5) {
+            stats = CacheStats{h, m, s, e, b};
+        }
+    }
+    if (update) {
+        update(stats);
+        int len = snprintf(buf, sizeof buf, "%llu %llu %llu %llu %llu\n",
+                           (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+                           (unsigned long long)stats.stores, (unsigned long long)stats.evictions,
+                           (unsigned long long)stats.bytes);
+        if (ftruncate(fd, 0) != 0 || pwrite(fd, buf, len, 0) != len) {
+            // las estadisticas son orientativas: un fallo no afecta al cache
+        }
+    }
+    flock(fd, LOCK_UN);
+    close(fd);
+    return stats;
+}
+
+// se llama con el lock de stats tomado: borra las entradas mas viejas hasta
+// bajar a 3/4 del limite, para no barrer el directorio en cada store
+void ArtifactCache::evict(CacheStats& stats) const {
+    struct Entry { timespec used; uint64_t size; string path; };
+    vector<Entry> entries;
+    uint64_t total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (!d) return;
+    while (dirent* de = readdir(d)) {
+        if (!isEntryName(de->d_name)) continue;
+        string path = dir + "/" + de->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        entries.push_back(Entry{st.st_mtim, (uint64_t)st.st_size, path});
+        total += (uint64_t)st.st_size;
+    }
+    closedir(d);
+    sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.used.tv_sec != b.used.tv_sec) return a.used.tv_sec < b.used.tv_sec;
+        return a.used.tv_nsec < b.used.tv_nsec;
+    });
+    uint64_t target = maxBytes - maxBytes / 4;
+    for (const Entry& e : entries) {
+        if (total <= target) break;
+        if (unlink(e.path.c_str()) == 0) {
+            total -= e.size;
+            ++stats.evictions;
+        }
+    }
+    stats.bytes = total; // recalculado: corrige lo que se haya desfasado
+}
+
+bool ArtifactCache::lookup(string_view source, CompileResult& out) const {
+    string key = normalize(source);
+    string path = entryPath(contentKey(key));
+
+    bool hit = false;
+    SourceBuffer file;
+    if (file.open(path)) {
+        // la entrada repite el fuente: dos fuentes con el mismo hash no se
+        // confunden, solo se pisan
+        string_view in = file.view();
+        string_view magic(CACHE_MAGIC), identity, stored, assembly, stack, asmMap;
+        if (in.substr(0, magic.size()) == magic) {
+            in.remove_prefix(magic.size());
+            hit = getStr(in, identity) && identity == compilerIdentity() &&
+                  getStr(in, stored) && stored == key &&
+                  getStr(in, assembly) && getStr(in, stack) && getStr(in, asmMap);
+        }
+        if (hit) {
+            out.ok = true;
+            out.assembly.assign(assembly);
+            out.stackJson.assign(stack);
+            out.asmMapJson.assign(asmMap);
+            out.diagnostics.clear();
+            // usada recien: queda al final de la cola de desalojo
+            utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        }
+    }
+    updateStats([&](CacheStats& s) { ++(hit ? s.hits : s.misses); });
+    return hit;
+}
+
+void ArtifactCache::store(string_view source, const CompileResult& result) const {
+    if (!result.ok) return;
+    string key = normalize(source);
+    string path = entryPath(contentKey(key));
+
+    string data = CACHE_MAGIC;
+    putStr(data, compilerIdentity());
+    putStr(data, key);
+    putStr(data, result.assembly);
+    putStr(data, result.stackJson);
+    putStr(data, result.asmMapJson);
+
+    // se escribe aparte y se renombra: un lector nunca ve una entrada a medias
+    static atomic<unsigned> counter{0};
+    string tmp = path + "." + to_string(getpid()) + "." + to_string(counter++) + ".tmp";
+    if (!writeFile(tmp, data)) {
+        remove(tmp.c_str());
+        return;
+    }
+    struct stat st;
+    uint64_t replaced = stat(path.c_str(), &st) == 0 ? (uint64_t)st.st_size : 0;
+    if (rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        return;
+    }
+    updateStats([&](CacheStats& s) {
+        ++s.stores;
+        s.bytes = s.bytes + data.size() >= replaced ? s.bytes + data.size() - replaced : 0;
+        if (s.bytes > maxBytes) evict(s);
+    });
+}
+
+CacheStats ArtifactCache::stats() const {
+    return updateStats(nullptr);
+}
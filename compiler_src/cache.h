@@ -0,0 +1,59 @@
+#ifndef CACHE_H
+#define CACHE_H
+// cache de artefactos en disco direccionado por contenido: la clave resume
+// el fuente normalizado y la identidad del compilador, y cada entrada guarda
+// el asm, el stack json y el mapa linea -> asm de una compilacion exitosa.
+// un acierto devuelve los artefactos sin tokenizar, parsear ni generar nada.
+//
+// el directorio se puede compartir entre procesos e hilos: las entradas se
+// escriben aparte y se renombran, y el archivo "stats" (aciertos, fallos,
+// bytes ocupados) se actualiza bajo flock. cuando los bytes pasan el limite
+// se borran las entradas usadas hace mas tiempo (la fecha de modificacion
+// se renueva en cada acierto).
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+struct CompileResult;
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+    uint64_t bytes = 0; // tamaño actual de las entradas
+};
+
+class ArtifactCache {
+private:
+    string dir;
+    uint64_t maxBytes;
+
+    string entryPath(uint64_t key) const;
+    // lee stats, aplica update y lo vuelve a escribir con el lock tomado
+    CacheStats updateStats(const function<void(CacheStats&)>& update) const;
+    void evict(CacheStats& stats) const;
+
+public:
+    static const uint64_t DEFAULT_MAX_BYTES = 256ull << 20;
+
+    // crea dir si no existe
+    explicit ArtifactCache(string dir, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+
+    // fuente con fin de linea \n y sin espacios al final de cada linea: no
+    // cambia tokens ni numeros de linea, asi que tampoco los artefactos
+    static string normalize(string_view source);
+
+    // true y los artefactos en out si hay una entrada para este fuente
+    bool lookup(string_view source, CompileResult& out) const;
+    // guarda un resultado exitoso (los fallidos no se guardan)
+    void store(string_view source, const CompileResult& result) const;
+
+    CacheStats stats() const;
+};
+
+#endif // CACHE_H
@@ -0,0 +1,160 @@
+#include "compi.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <vector>
+#include "token_stream.h"
+#include "parser.h"
+#include "ast.h"
+#include "visitor.h"
+#include "TypeChecker.h"
+#include "cache.h"
+#include "session.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+// flujo: tokenizar, parsear declaraciones, verificar globales y firmas, y
+// luego cada funcion alcanzable desde main: parsear, verificar y emitir
+static void compilar(string_view source, const CompileOptions& options, Diagnostics& diags,
+                     EstadisticasPeephole& peephole, ostream& asmOut, ostream& stackOut, ostream& asmMapOut) {
+    // tokenizacion por lotes (SIMD) de todo el archivo; el parser lee los arreglos
+    TokenStream tokens = tokenizeAll(source);
+    Parser parser(&tokens, diags);
+    // globales y firmas completas; los cuerpos solo quedan delimitados
+    unique_ptr<Program> program(parser.parseDeclarations());
+
+    TypeChecker tc(diags);
+    tc.beginProgram(program.get());
+
+    GenCodeVisitor codigo(asmOut, &stackOut, &asmMapOut);
+    codigo.iniciarPrograma(program.get());
+
+    CompileSession* session = options.session;
+    if (session) session->setProgram(*program);
+
+    ThreadPool sequential(1);
+    ThreadPool& pool = options.pool ? *options.pool : sequential;
+
+    // las funciones van por lotes: se parsean los cuerpos del lote, se
+    // verifican en paralelo y se emiten en orden. los cuerpos viven en
+    // bodyArena y se liberan al cerrar el lote, asi la memoria pico depende
+    // del lote y no del archivo completo.
+    // los cuerpos que main nunca alcanza no se parsean ni se emiten.
+    const size_t BATCH = 256;
+    Arena bodyArena;
+    vector<FunDec*> reachable = parser.reachableFrom(program.get(), "main");
+    for (size_t start = 0; start < reachable.size(); start += BATCH) {
+        size_t stop = min(reachable.size(), start + BATCH);
+        struct Pending { FunDec* fd; int braceLine; uint64_t key; const CompileSession::Entry* prev; };
+        vector<Pending> batch;
+        vector<FunDec*> parsed;
+        // un error de parseo del lote se reporta despues de los errores
+        // de tipo anteriores, como si se hubiera ido funcion por funcion
+        Diagnostics batchDiags;
+        bool parseFailed = false;
+        parser.setDiagnostics(batchDiags);
+        for (size_t i = start; i < stop; ++i) {
+            FunDec* fd = reachable[i];
+            Pending p{fd, (int)tokens.line[fd->bodyBegin], 0, nullptr};
+            if (session) {
+                p.key = session->keyFor(tokens, *fd);
+                // mismo texto y mismas dependencias: ya fue verificada
+                p.prev = session->reuse(p.key);
+            }
+            if (!p.prev) {
+                try {
+                    parser.parseFunctionBody(fd, bodyArena);
+                } catch (const CompileError&) {
+                    parseFailed = true;
+                    break;
+                }
+                parsed.push_back(fd);
+            }
+            batch.push_back(p);
+        }
+        parser.setDiagnostics(diags);
+        // lo anterior al primer error se emite igual que en secuencial
+        size_t bad = tc.checkFunctions(parsed, pool);
+        FunDec* failing = bad < parsed.size() ? parsed[bad] : nullptr;
+        // las verificadas se generan en paralelo, cada una con sus propias
+        // etiquetas y snapshots desde 0; enlazarlas en orden renumera todo
+        // y el .s queda identico al de una generacion en serie
+        vector<FunctionCode> generated = codigo.compilarFunciones(
+            vector<FunDec*>(parsed.begin(), parsed.begin() + bad), pool);
+
+        size_t nextGenerated = 0;
+        for (Pending& p : batch) {
+            if (p.prev) {
+                codigo.enlazarFuncion(p.prev->code, p.braceLine - p.prev->braceLine);
+                continue;
+            }
+            if (p.fd == failing) tc.checkFunction(p.fd); // registra el error y lanza
+            FunctionCode code = std::move(generated[nextGenerated++]);
+            peephole.sumar(code.peephole);
+            codigo.enlazarFuncion(code);
+            asmOut.flush();
+            if (session) session->store(p.key, std::move(code), p.braceLine);
+            p.fd->cuerpo = nullptr;
+        }
+        bodyArena.reset();
+        if (parseFailed) {
+            diags.append(batchDiags);
+            throw CompileError(batchDiags.all().front().message);
+        }
+    }
+    tc.endProgram();
+    codigo.terminarPrograma();
+}
+
+const string& compilerIdentity() {
+    static const string identity = [] {
+        struct stat st;
+        if (stat("/proc/self/exe", &st) != 0) return string();
+        return to_string(st.st_size) + ":" + to_string(st.st_mtim.tv_sec) + "." +
+               to_string(st.st_mtim.tv_nsec);
+    }();
+    return identity;
+}
+
+CompileResult compile(string_view source, const CompileOptions& options) {
+    ArtifactCache* cache = options.session ? nullptr : options.cache;
+    if (cache) {
+        CompileResult result;
+        if (!cache->lookup(source, result)) {
+            // se compila a buffers para poder guardar el asm completo
+            CompileOptions uncached = options;
+            uncached.cache = nullptr;
+            uncached.asmOut = nullptr;
+            result = compile(source, uncached);
+            cache->store(source, result);
+        }
+        if (options.asmOut && result.ok) {
+            *options.asmOut << result.assembly;
+            result.assembly.clear();
+        }
+        return result;
+    }
+
+    CompileResult result;
+    ostringstream assembly, stackJson, asmMapJson;
+    try {
+        compilar(source, options, result.diagnostics, result.peephole,
+                 options.asmOut ? *options.asmOut : assembly, stackJson, asmMapJson);
+    } catch (const CompileError&) {
+        // la fase que fallo ya dejo su diagnostico
+        return result;
+    } catch (const exception& e) {
+        // un error que ninguna fase esperaba (memoria, un bug): se reporta
+        // como diagnostico para que no termine el proceso que aloja al
+        // compilador (el daemon, un worker del modo por lotes)
+        result.diagnostics.error("interno", 0, 0, string("error interno: ") + e.what());
+        return result;
+    }
+    result.ok = true;
+    result.assembly = assembly.str();
+    result.stackJson = stackJson.str();
+    result.asmMapJson = asmMapJson.str();
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef COMPI_H
+#define COMPI_H
+// libcompi: el compilador como biblioteca. compile() toma el codigo fuente en
+// memoria y devuelve el asm, los snapshots de stack y el mapa linea -> asm en
+// buffers, sin tocar el sistema de archivos ni escribir en cout/cerr.
+// cada llamada es duena de todo su estado (interner de nombres, arenas del
+// ast, checker y generador) y no hay estado global mutable, asi que se puede
+// compilar desde varios hilos a la vez. lo que se pasa en CompileOptions
+// (pool, sesion) es de una sola compilacion por vez.
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "diagnostics.h"
+#include "peephole.h"
+
+using namespace std;
+
+class ArtifactCache;
+class CompileSession;
+class ThreadPool;
+
+struct CompileOptions {
+    // verifica cuerpos en paralelo sobre este pool (nullptr: en el hilo que
+    // llama). un pool no se puede usar en dos compilaciones a la vez.
+    ThreadPool* pool = nullptr;
+    // modo incremental: reutiliza y actualiza el asm de cada funcion
+    CompileSession* session = nullptr;
+    // cache de artefactos por contenido (ver cache.h): un acierto devuelve el
+    // resultado sin correr ninguna fase. no se usa junto con session, que
+    // necesita ver cada funcion para guardar su estado.
+    ArtifactCache* cache = nullptr;
+    // si no es nullptr el asm se escribe aca a medida que se genera, funcion
+    // por funcion, y CompileResult::assembly queda vacio
+    ostream* asmOut = nullptr;
+};
+
+struct CompileResult {
+    bool ok = false;
+    string assembly;   // .s completo
+    string stackJson;  // snapshots de stack para el front
+    string asmMapJson; // linea fuente -> instrucciones
+    Diagnostics diagnostics;
+    // reescrituras de la mirilla en las funciones generadas en esta llamada
+    // (las reutilizadas de la sesion o de la cache no cuentan)
+    EstadisticasPeephole peephole;
+};
+
+// identidad del binario que compila (tamaño y fecha del ejecutable): la
+// cache y las sesiones guardan asm generado, y un compilador nuevo no debe
+// reutilizar el del anterior
+const string& compilerIdentity();
+
+// no lanza: los errores de compilacion, y cualquier excepcion inesperada,
+// vuelven como diagnosticos con ok = false. source debe seguir vivo durante
+// la llamada
+CompileResult compile(string_view source, const CompileOptions& options = CompileOptions());
+
+#endif // COMPI_H
@@ -0,0 +1,351 @@
+#include "daemon.h"
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "compi.h"
+
+using namespace std;
+
+namespace {
+
+const uint32_t MAX_FRAME = 64u << 20; // pedidos mas grandes cierran la conexion
+// bytes de fuente leidos que pueden esperar un worker: con la cola llena los
+// lectores dejan de leer sus sockets, asi la memoria no crece con lo que
+// manden los clientes (mas, como mucho, un pedido a medio encolar por
+// conexion). un pedido solo entra siempre aunque pase el limite.
+const size_t MAX_ENCOLADO = 256u << 20;
+// por conexion: pedidos leidos cuya respuesta todavia no se entrego al
+// escritor. un cliente no ocupa la cola entera con lo suyo
+const int MAX_EN_VUELO = 16;
+// por conexion: respuestas listas que el cliente no leyo. pasado esto (o si
+// un write queda trabado ESPERA_ESCRITURA segundos) la conexion se corta:
+// un cliente que no lee no frena a los workers ni a los demas clientes
+const size_t MAX_SIN_ENVIAR = 64u << 20;
+const int ESPERA_ESCRITURA = 30;
+
+// extremo de una conexion. los workers no escriben en el socket: dejan la
+// respuesta en outbox y el hilo escritor de la conexion la manda. se cierra
+// cuando el lector termino y ya no quedan pedidos ni respuestas suyas
+struct Connection {
+    int in;
+    int out;
+    mutex mtx;
+    condition_variable changed;
+    deque<string> outbox;
+    size_t unsent = 0;     // bytes en outbox
+    int inFlight = 0;      // pedidos encolados o compilandose
+    bool readerDone = false;
+    bool broken = false;   // cortada: se descarta lo que falte
+
+    Connection(int in, int out) : in(in), out(out) {}
+    ~Connection() {
+        if (in > 2) close(in);
+        if (out > 2 && out != in) close(out);
+    }
+
+    // el lector espera lugar antes de encolar otro pedido; false si se corto
+    bool reserve() {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return broken || inFlight < MAX_EN_VUELO; });
+        if (broken) return false;
+        ++inFlight;
+        return true;
+    }
+
+    // un worker entrega la respuesta de un pedido (vacia: no hay respuesta);
+    // nunca espera al cliente
+    void deliver(string response) {
+        {
+            lock_guard<mutex> lock(mtx);
+            --inFlight;
+            if (!broken && !response.empty()) {
+                unsent += response.size();
+                outbox.push_back(std::move(response));
+                if (unsent > MAX_SIN_ENVIAR) breakLocked();
+            }
+        }
+        changed.notify_all();
+    }
+
+    void finishReading() {
+        {
+            lock_guard<mutex> lock(mtx);
+            readerDone = true;
+        }
+        changed.notify_all();
+    }
+
+    void fail() {
+        {
+            lock_guard<mutex> lock(mtx);
+            breakLocked();
+        }
+        changed.notify_all();
+    }
+
+    // siguiente respuesta para el escritor; false cuando no va a haber mas
+    bool next(string& response) {
+        unique_lock<mutex> lock(mtx);
+        changed.wait(lock, [&] { return broken || !outbox.empty() || (readerDone && inFlight == 0); });
+        if (broken || outbox.empty()) return false;
+        response = std::move(outbox.front());
+        outbox.pop_front();
+        unsent -= response.size();
+        return true;
+    }
+
+    bool readFull(char* p, size_t n) {
+        while (n > 0) {
+            ssize_t r = read(in, p, n);
+            if (r <= 0) return false;
+            p += r;
+            n -= (size_t)r;
+        }
+        return true;
+    }
+
+    bool writeFull(const string& data) {
+        const char* p = data.data();
+        size_t n = data.size();
+        while (n > 0) {
+            ssize_t w = write(out, p, n);
+            if (w <= 0) return false;
+            p += w;
+            n -= (size_t)w;
+        }
+        return true;
+    }
+
+private:
+    void breakLocked() {
+        broken = true;
+        outbox.clear();
+        unsent = 0;
+        // despierta al lector trabado en read(); en stdin/stdout no aplica
+        if (in > 2) ::shutdown(in, SHUT_RDWR);
+    }
+};
+
+struct Job {
+    shared_ptr<Connection> conn;
+    uint32_t id;
+    string source;
+};
+
+// cola acotada (en bytes) de pedidos compartida por los workers
+class JobQueue {
+private:
+    deque<Job> jobs;
+    size_t bytes = 0;
+    mutex mtx;
+    condition_variable ready;   // hay pedidos (o se cerro)
+    condition_variable hasRoom; // hay lugar
+    bool closed = false;
+
+public:
+    // espera lugar si la cola esta llena
+    void push(Job job) {
+        {
+            unique_lock<mutex> lock(mtx);
+            hasRoom.wait(lock, [&] { return jobs.empty() || bytes + job.source.size() <= MAX_ENCOLADO; });
+            bytes += job.source.size();
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+    }
+
+    // false cuando la cola esta cerrada y vacia
+    bool pop(Job& job) {
+        {
+            unique_lock<mutex> lock(mtx);
+            ready.wait(lock, [&] { return closed || !jobs.empty(); });
+            if (jobs.empty()) return false;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            bytes -= job.source.size();
+        }
+        hasRoom.notify_all();
+        return true;
+    }
+
+    void close() {
+        {
+            lock_guard<mutex> lock(mtx);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+};
+
+void putU32(string& buf, uint32_t v) {
+    char b[4] = {char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+    buf.append(b, 4);
+}
+
+uint32_t getU32(const char* b) {
+    return uint32_t((unsigned char)b[0]) | uint32_t((unsigned char)b[1]) << 8 |
+           uint32_t((unsigned char)b[2]) << 16 | uint32_t((unsigned char)b[3]) << 24;
+}
+
+void putStr(string& buf, const string& s) {
+    putU32(buf, (uint32_t)s.size());
+    buf += s;
+}
+
+string encodeResponse(uint32_t id, const CompileResult& r) {
+    string body;
+    putU32(body, id);
+    body += char(r.ok ? 1 : 0);
+    putStr(body, r.assembly);
+    putStr(body, r.stackJson);
+    putStr(body, r.asmMapJson);
+    putStr(body, r.diagnostics.render());
+    string frame;
+    putU32(frame, (uint32_t)body.size());
+    return frame + body;
+}
+
+void workerLoop(JobQueue& queue, ArtifactCache* cache) {
+    CompileOptions options;
+    options.cache = cache;
+    Job job;
+    while (queue.pop(job)) {
+        // cada pedido compila aislado: su AST vive en arenas propios y se
+        // libera al volver de compile(). compile() no lanza, pero un pedido
+        // que falle igual (ej. sin memoria para la respuesta) no debe
+        // terminar el proceso con los pedidos de las demas conexiones
+        string response;
+        try {
+            response = encodeResponse(job.id, compile(job.source, options));
+        } catch (const exception& e) {
+            CompileResult failed;
+            failed.diagnostics.error("interno", 0, 0, string("error interno: ") + e.what());
+            try {
+                response = encodeResponse(job.id, failed);
+            } catch (const exception&) {
+                response.clear(); // sin respuesta: el cliente ve la conexion cerrarse
+            }
+        }
+        job.conn->deliver(std::move(response));
+        job = Job();
+    }
+}
+
+// manda las respuestas de la conexion a medida que los workers las dejan
+void writeResponses(shared_ptr<Connection> conn) {
+    string response;
+    while (conn->next(response)) {
+        if (!conn->writeFull(response)) conn->fail(); // cliente ido o trabado
+    }
+}
+
+// lee pedidos hasta EOF o un pedido invalido y los encola; vuelve cuando la
+// conexion mando todas sus respuestas
+void serveConnection(shared_ptr<Connection> conn, shared_ptr<JobQueue> queue) {
+    thread writer(writeResponses, conn);
+    char header[8];
+    while (conn->readFull(header, 4)) {
+        uint32_t size = getU32(header);
+        if (size < 4 || size > MAX_FRAME) break;
+        if (!conn->readFull(header + 4, 4)) break;
+        Job job{conn, getU32(header + 4), string(size - 4, '\0')};
+        if (!conn->readFull(&job.source[0], job.source.size())) break;
+        if (!conn->reserve()) break;
+        queue->push(std::move(job));
+    }
+    conn->finishReading();
+    writer.join();
+}
+
+} // namespace
+
+int runDaemon(const string& socketPath, unsigned workers, ArtifactCache* cache) {
+    signal(SIGPIPE, SIG_IGN); // un cliente que se va no debe tumbar el servidor
+    if (workers == 0) workers = thread::hardware_concurrency();
+    if (workers == 0) workers = 1;
+
+    // los lectores de cada conexion van sueltos: comparten la cola
+    auto queue = make_shared<JobQueue>();
+    vector<thread> pool;
+    for (unsigned i = 0; i < workers; ++i) pool.emplace_back(workerLoop, ref(*queue), cache);
+    auto shutdown = [&] {
+        queue->close();
+        for (thread& t : pool) t.join();
+    };
+
+    if (socketPath == "-") {
+        serveConnection(make_shared<Connection>(0, 1), queue);
+        shutdown(); // stdin cerrado: terminar lo pendiente y salir
+        return 0;
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        cerr << "ruta de socket demasiado larga: " << socketPath << endl;
+        shutdown();
+        return 1;
+    }
+    strcpy(addr.sun_path, socketPath.c_str());
+    // un socket que todavia acepta conexiones es de otro daemon vivo: no se
+    // le quita la ruta. si nadie responde es de una ejecucion anterior
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool alive = probe >= 0 && connect(probe, (sockaddr*)&addr, sizeof addr) == 0;
+    if (probe >= 0) close(probe);
+    if (alive) {
+        cerr << "ya hay un daemon escuchando en " << socketPath << endl;
+        shutdown();
+        return 1;
+    }
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str()); // socket viejo de una ejecucion anterior
+    if (server < 0 || bind(server, (sockaddr*)&addr, sizeof addr) != 0 || listen(server, 64) != 0) {
+        cerr << "no se pudo escuchar en " << socketPath << ": " << strerror(errno) << endl;
+        if (server >= 0) close(server);
+        shutdown();
+        return 1;
+    }
+    cout << "compi escuchando en " << socketPath << " con " << workers << " workers" << endl;
+
+    while (true) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) {
+            // sin descriptores o memoria es pasajero: se espera a que
+            // terminen otras conexiones. un cliente que se fue antes del
+            // accept tampoco es motivo para dejar de escuchar
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                this_thread::sleep_for(chrono::milliseconds(100));
+                continue;
+            }
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) continue;
+            cerr << "accept: " << strerror(errno) << endl;
+            break;
+        }
+        timeval espera{ESPERA_ESCRITURA, 0};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &espera, sizeof espera);
+        auto conn = make_shared<Connection>(client, client);
+        try {
+            thread(serveConnection, conn, queue).detach();
+        } catch (const system_error&) {
+            // sin hilos libres: se cierra esta conexion y se sigue
+        }
+    }
+    close(server);
+    shutdown();
+    return 1;
+}
@@ -0,0 +1,32 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+// modo servidor: el proceso queda vivo y recibe programas por un socket unix
+// (o por stdin/stdout) para no pagar el arranque ni ir al disco en cada
+// compilacion. los pedidos se compilan en paralelo en un pool de workers,
+// cada uno con sus propios arenas (ver compile() en compi.h).
+//
+// protocolo: enteros de 32 bits little-endian; str = u32 largo + bytes
+//   pedido:    u32 largo | u32 id | fuente
+//   respuesta: u32 largo | u32 id | u8 ok | str asm | str stack json
+//              | str asm-map json | str diagnosticos
+// las respuestas de una conexion pueden salir en otro orden que los
+// pedidos; el id del pedido vuelve en su respuesta. una conexion tiene a lo
+// sumo 16 pedidos en vuelo (despues el daemon deja de leerla hasta que salga
+// una respuesta). las respuestas las manda un hilo por conexion: si el
+// cliente deja de leerlas y se le acumulan 64 MB, o un envio queda trabado
+// 30 s, la conexion se corta sin frenar a los workers ni a otros clientes.
+
+#include <string>
+
+using namespace std;
+
+class ArtifactCache;
+
+// socketPath "-" usa stdin/stdout y termina al cerrarse stdin; si no, escucha
+// en ese socket hasta que el proceso muera (y no arranca si otro daemon ya
+// acepta conexiones ahi). workers 0 = uno por nucleo.
+// con cache, los pedidos repetidos se responden desde ahi.
+// devuelve el codigo de salida del proceso.
+int runDaemon(const string& socketPath, unsigned workers, ArtifactCache* cache = nullptr);
+
+#endif // DAEMON_H
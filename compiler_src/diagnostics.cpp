@@ -0,0 +1,30 @@
+#include "diagnostics.h"
+
+using namespace std;
+
+void Diagnostics::error(const string& phase, int line, int col, const string& message) {
+    items.push_back(Diagnostic{phase, line, col, message});
+}
+
+void Diagnostics::append(const Diagnostics& other) {
+    items.insert(items.end(), other.items.begin(), other.items.end());
+}
+
+void Diagnostics::clear() {
+    items.clear();
+}
+
+string Diagnostics::render() const {
+    string out;
+    for (const Diagnostic& d : items) {
+        if (d.line > 0) {
+            out += "linea " + to_string(d.line);
+            if (d.col > 0) out += ":" + to_string(d.col);
+            out += ": ";
+        }
+        if (d.phase == "parseo") out += "Error de parseo: ";
+        else if (d.phase == "lexico") out += "Error léxico: ";
+        out += d.message + "\n";
+    }
+    return out;
+}
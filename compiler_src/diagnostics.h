@@ -0,0 +1,45 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+// diagnosticos de compilacion. cada fase registra sus errores aqui (con
+// linea y columna cuando las conoce) y lanza CompileError para desenrollar
+// hasta quien la llamo, que decide como reportarlos. ninguna fase termina
+// el proceso, asi el compilador puede vivir dentro de un servidor.
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Diagnostic {
+    string phase;   // "lexico", "parseo", "tipos", "interno"
+    int line;       // 0 si no se conoce
+    int col;        // 0 si no se conoce
+    string message;
+};
+
+// la fase ya registro el diagnostico; solo sirve para desenrollar
+class CompileError : public runtime_error {
+public:
+    explicit CompileError(const string& msg) : runtime_error(msg) {}
+};
+
+class Diagnostics {
+private:
+    vector<Diagnostic> items;
+
+public:
+    void error(const string& phase, int line, int col, const string& message);
+    // agrega los diagnosticos de other al final (ej. los de un lote parseado aparte)
+    void append(const Diagnostics& other);
+    void clear();
+
+    bool hasErrors() const { return !items.empty(); }
+    const vector<Diagnostic>& all() const { return items; }
+
+    // una linea por diagnostico, como las imprimia cada fase, con la
+    // posicion al frente cuando se conoce
+    string render() const;
+};
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,197 @@
+import os
+import glob
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# prueba diferencial contra gcc: genera programas aleatorios del lenguaje
+# que tambien son c valido, los compila con nuestro compilador y con gcc y
+# compara lo que imprimen. los que no coinciden quedan en fallas/.
+#
+# uso: python3 diferencial_gcc.py [cantidad] [semilla_inicial] [binario]
+# (el binario por defecto es ./a.out, el que deja run_all_inputs.py; si no
+# existe se compila)
+
+ENTEROS = ["a", "b", "c", "d"]
+LARGOS = ["e", "f"]
+FLOTANTES = ["x", "y"]
+FORMATOS = {"e": "%ld", "f": "%ld", "x": "%f", "y": "%f"}
+
+
+class Generador:
+    # f1 modifica g: g no se lee dentro de expresiones (el orden de
+    # evaluacion de los operandos no esta definido en c). los valores se
+    # recortan despues de cada asignacion para no depender del desborde.
+    def __init__(self, semilla):
+        self.rnd = random.Random(semilla)
+
+    def entera(self, d, vs):
+        r = self.rnd.random()
+        if d == 0 or r < 0.2:
+            return self.rnd.choice(vs + [str(self.rnd.randint(0, 20))])
+        if r < 0.3:
+            return "f1(%s, %s)" % (self.entera(d - 1, ENTEROS), self.entera(d - 1, ENTEROS))
+        if r < 0.35:
+            return "(%s < %s ? %s : %s)" % (self.entera(d - 1, vs), self.entera(d - 1, vs),
+                                            self.entera(d - 1, ENTEROS), self.entera(d - 1, ENTEROS))
+        if r < 0.4:
+            return "(%s / %d)" % (self.entera(d - 1, vs), self.rnd.randint(1, 9))
+        op = self.rnd.choice(["+", "-", "*"])
+        return "(%s %s %s)" % (self.entera(d - 1, vs), op, self.entera(d - 1, vs))
+
+    def flotante(self, d):
+        r = self.rnd.random()
+        if d == 0 or r < 0.25:
+            return self.rnd.choice(FLOTANTES + ["%d.5" % self.rnd.randint(0, 9)])
+        if r < 0.33:
+            return "f3(%s, %s)" % (self.flotante(d - 1), self.flotante(d - 1))
+        if r < 0.4:
+            return "(%s < %s ? %s : %s)" % (self.flotante(d - 1), self.flotante(d - 1),
+                                            self.flotante(d - 1), self.flotante(d - 1))
+        op = self.rnd.choice(["+", "-", "*"])
+        return "(%s %s %s)" % (self.flotante(d - 1), op, self.flotante(d - 1))
+
+    def condicion(self):
+        k = self.rnd.random()
+        if k < 0.6:
+            return "%s < %s" % (self.entera(2, ENTEROS), self.entera(2, ENTEROS))
+        if k < 0.8:
+            return "%s < %s" % (self.flotante(1), self.flotante(1))
+        return "%s < %s" % (self.entera(1, LARGOS + ENTEROS), self.entera(1, LARGOS + ENTEROS))
+
+    def sentencia(self, prof, ind):
+        p = "    " * ind
+        k = self.rnd.random()
+        if k < 0.45 or prof == 0:
+            v = self.rnd.choice(ENTEROS + LARGOS + FLOTANTES + ["g"])
+            if v in ENTEROS or v == "g":
+                return [p + "%s = %s;" % (v, self.entera(3, ENTEROS)),
+                        p + "%s = %s - %s / 1000 * 1000;" % (v, v, v)]
+            if v in LARGOS:
+                return [p + "%s = %s;" % (v, self.entera(3, ENTEROS + LARGOS)),
+                        p + "%s = %s - %s / 100000 * 100000;" % (v, v, v)]
+            return [p + "%s = %s;" % (v, self.flotante(2)),
+                    p + "if (100.0 < %s) { %s = 1.5; }" % (v, v),
+                    p + "if (%s < -100.0) { %s = 2.5; }" % (v, v)]
+        out = []
+        if k < 0.6:
+            out.append(p + "if (%s) {" % self.condicion())
+            for _ in range(self.rnd.randint(1, 3)):
+                out += self.sentencia(prof - 1, ind + 1)
+            out.append(p + "} else {")
+            for _ in range(self.rnd.randint(1, 3)):
+                out += self.sentencia(prof - 1, ind + 1)
+            out.append(p + "}")
+        elif k < 0.7:
+            i = "k%d" % ind
+            out.append(p + "for (int %s = 0; %s < %d; %s++) {" % (i, i, self.rnd.randint(1, 5), i))
+            for _ in range(self.rnd.randint(1, 3)):
+                out += self.sentencia(prof - 1, ind + 1)
+            out.append(p + "}")
+        elif k < 0.8:
+            # un contador por profundidad: un while anidado no toca el de afuera
+            w = "w%d" % prof
+            out.append(p + "%s = 0;" % w)
+            out.append(p + "while (%s < %d) {" % (w, self.rnd.randint(1, 4)))
+            for _ in range(self.rnd.randint(1, 2)):
+                out += self.sentencia(prof - 1, ind + 1)
+            out.append(p + "    %s = %s + 1;" % (w, w))
+            out.append(p + "}")
+        else:
+            v = self.rnd.choice(ENTEROS + LARGOS + FLOTANTES)
+            out.append(p + 'printf("%s\\n", %s);' % (FORMATOS.get(v, "%d"), v))
+        return out
+
+    def programa(self):
+        o = ["#include <stdio.h>", "", "int g;", "",
+             "int f1(int p, int q) {", "    g = g + 1;", "    return p * q - p;", "}", "",
+             "float f3(float p, float q) {", "    return p * q - p;", "}", "",
+             "int main() {"]
+        for v in ENTEROS:
+            o.append("    int %s;" % v)
+        for v in LARGOS:
+            o.append("    long %s;" % v)
+        for v in FLOTANTES:
+            o.append("    float %s;" % v)
+        for prof in range(4):
+            o.append("    int w%d;" % prof)
+        for i, v in enumerate(ENTEROS + LARGOS):
+            o.append("    %s = %d;" % (v, i + 1))
+        o += ["    x = 1.5;", "    y = 2.5;", "    g = 0;"]
+        for _ in range(self.rnd.randint(4, 12)):
+            o += self.sentencia(3, 1)
+        for v in ENTEROS + LARGOS + FLOTANTES + ["g"]:
+            o.append('    printf("%s\\n", %s);' % (FORMATOS.get(v, "%d"), v))
+        o += ["    return 0;", "}"]
+        return "\n".join(o) + "\n"
+
+
+def ejecutar(exe):
+    # None si no termina: el programa generado puede no terminar y no hay
+    # nada que comparar
+    try:
+        r = subprocess.run([exe], capture_output=True, text=True, timeout=2)
+    except subprocess.TimeoutExpired:
+        return None
+    # printf del lenguaje deja un espacio antes del salto de linea
+    return r.returncode, [l.rstrip() for l in r.stdout.splitlines()]
+
+
+def main():
+    cantidad = int(sys.argv[1]) if len(sys.argv) > 1 else 100
+    inicio = int(sys.argv[2]) if len(sys.argv) > 2 else 1
+    binario = os.path.abspath(sys.argv[3] if len(sys.argv) > 3 else "a.out")
+    if not os.path.isfile(binario):
+        fuentes = sorted(glob.glob("*.cpp"))
+        print("Compilando:", binario)
+        r = subprocess.run(["g++", "-std=c++17", "-pthread"] + fuentes + ["-o", binario],
+                           capture_output=True, text=True)
+        if r.returncode != 0:
+            print("Error en compilación:\n", r.stderr)
+            exit(1)
+
+    tmp = tempfile.mkdtemp()
+    fallas = saltados = 0
+    try:
+        for semilla in range(inicio, inicio + cantidad):
+            fuente = Generador(semilla).programa()
+            txt = os.path.join(tmp, "p.txt")
+            with open(txt, "w") as f:
+                f.write(fuente)
+
+            referencia = None
+            if subprocess.run(["gcc", "-x", "c", "-w", "-fwrapv", txt, "-o", os.path.join(tmp, "ref")],
+                              capture_output=True).returncode == 0:
+                referencia = ejecutar(os.path.join(tmp, "ref"))
+            if referencia is None:
+                saltados += 1
+                continue
+
+            motivo = None
+            r = subprocess.run([binario, "p.txt"], cwd=tmp, capture_output=True, text=True, timeout=30)
+            if r.returncode != 0:
+                motivo = "no compila:\n" + r.stdout
+            elif subprocess.run(["gcc", os.path.join(tmp, "p.s"), "-o", os.path.join(tmp, "nuestro")],
+                                capture_output=True).returncode != 0:
+                motivo = "el asm no ensambla"
+            else:
+                obtenido = ejecutar(os.path.join(tmp, "nuestro"))
+                if obtenido != referencia:
+                    motivo = "salida distinta de gcc" if obtenido else "no termina"
+            if motivo:
+                fallas += 1
+                os.makedirs("fallas", exist_ok=True)
+                destino = os.path.join("fallas", f"semilla_{semilla}.txt")
+                shutil.copy(txt, destino)
+                print(f"semilla {semilla}: {motivo} ({destino})")
+    finally:
+        shutil.rmtree(tmp)
+
+    print(f"{cantidad} programas, {fallas} fallas, {saltados} sin referencia")
+    exit(1 if fallas else 0)
+
+
+if __name__ == "__main__":
+    main()
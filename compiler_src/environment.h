@@ -1,98 +1,157 @@
 #ifndef ENVIRONMENT_H
 #define ENVIRONMENT_H
 
-#include <unordered_map>
+#include <stdexcept>
 #include <vector>
 #include <string>
-#include <iostream>
+#include "interner.h"
 
 using namespace std;
 
-// entorno en forma de pila para scopes y busquedas
+// entorno con scopes para busquedas por simbolo internado.
+// una sola tabla hash (direccionamiento abierto) va de simbolo a la ultima
+// declaracion visible; cada declaracion guarda la que sombrea. las
+// declaraciones se apilan en orden, asi la pila sirve de log para deshacer:
+// remove_level solo recorre lo declarado en ese nivel.
 
 template <typename T>
 class Environment {
 private:
-    vector<unordered_map<string, T>> ribs;
+    struct Binding {
+        Symbol var;
+        int level;   // nivel donde se declaro
+        int shadow;  // binding sombreada (-1 si no hay)
+        T value;
+    };
+    struct Slot {
+        Symbol var; // -1: vacio
+        int top;    // binding visible (-1 si ya no hay ninguna)
+    };
+
+    vector<Slot> table;      // potencia de 2; las claves no se borran
+    size_t keys = 0;
+    vector<Binding> bindings;
+    vector<size_t> marks;    // bindings.size() al abrir cada nivel
+
+    static size_t hashOf(Symbol var) {
+        return static_cast<size_t>(var) * 0x9E3779B97F4A7C15ull;
+    }
+
+    // slot de var, o el vacio donde iria
+    size_t probe(Symbol var) const {
+        size_t mask = table.size() - 1;
+        size_t i = hashOf(var) & mask;
+        while (table[i].var != var && table[i].var != -1) i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow() {
+        vector<Slot> old(table.size() * 2, Slot{-1, -1});
+        old.swap(table);
+        for (const Slot& s : old) {
+            if (s.var != -1) table[probe(s.var)] = s;
+        }
+    }
+
+    int topOf(Symbol var) const {
+        if (table.empty()) return -1;
+        const Slot& s = table[probe(var)];
+        return s.var == var ? s.top : -1;
+    }
 
-    int search_rib(const string& var) const {
-        for (int idx = static_cast<int>(ribs.size()) - 1; idx >= 0; --idx) {
-            auto it = ribs[idx].find(var);
-            if (it != ribs[idx].end())  // encontrado
-                return idx;
+    void requireLevel() const {
+        if (marks.empty()) {
+            throw logic_error("Environment sin niveles: no se pueden agregar variables");
         }
-        return -1; // no encontrado
     }
 
 public:
-    Environment() = default;
+    Environment() : table(16, Slot{-1, -1}) {}
 
     // Limpia completamente el entorno
     void clear() {
-        ribs.clear();
+        for (const Binding& b : bindings) table[probe(b.var)].top = -1;
+        bindings.clear();
+        marks.clear();
     }
 
     // Agrega un nuevo nivel (scope)
     void add_level() {
-        ribs.emplace_back();
+        marks.push_back(bindings.size());
     }
 
     // Agrega una variable con un valor inicial
-    void add_var(const string& var, const T& value) {
-        if (ribs.empty()) {
-            cerr << "[Error] Environment sin niveles: no se pueden agregar variables.\n";
-            exit(EXIT_FAILURE);
+    void add_var(Symbol var, const T& value) {
+        requireLevel();
+        if (2 * (keys + 1) > table.size()) grow();
+        Slot& s = table[probe(var)];
+        if (s.var == -1) {
+            s = Slot{var, -1};
+            ++keys;
         }
-        ribs.back()[var] = value;
+        int level = static_cast<int>(marks.size()) - 1;
+        if (s.top >= 0 && bindings[s.top].level == level) {
+            bindings[s.top].value = value; // redeclaracion en el mismo nivel
+            return;
+        }
+        bindings.push_back(Binding{var, level, s.top, value});
+        s.top = static_cast<int>(bindings.size()) - 1;
     }
 
     // Agrega una variable con valor por defecto (solo si T es numérico o tiene constructor por defecto)
-    void add_var(const string& var) {
-        if (ribs.empty()) {
-            cerr << "[Error] Environment sin niveles: no se pueden agregar variables.\n";
-            exit(EXIT_FAILURE);
-        }
-        ribs.back()[var] = T(); // inicializa con valor por defecto
+    void add_var(Symbol var) {
+        add_var(var, T());
     }
 
     // Elimina el nivel más interno
     bool remove_level() {
-        if (!ribs.empty()) {
-            ribs.pop_back();
-            return true;
+        if (marks.empty()) return false;
+        size_t mark = marks.back();
+        marks.pop_back();
+        while (bindings.size() > mark) {
+            const Binding& b = bindings.back();
+            table[probe(b.var)].top = b.shadow;
+            bindings.pop_back();
         }
-        return false;
+        return true;
     }
 
     // Actualiza el valor de una variable existente
-    bool update(const string& x, const T& v) {
-        int idx = search_rib(x);
-        if (idx < 0) return false;
-        ribs[idx][x] = v;
+    bool update(Symbol x, const T& v) {
+        T* slot = find(x);
+        if (!slot) return false;
+        *slot = v;
         return true;
     }
 
+    // Valor visible de x o nullptr; una sola busqueda para check + lookup.
+    // el puntero vale hasta el siguiente add_var
+    const T* find(Symbol x) const {
+        int top = topOf(x);
+        return top >= 0 ? &bindings[top].value : nullptr;
+    }
+    T* find(Symbol x) {
+        int top = topOf(x);
+        return top >= 0 ? &bindings[top].value : nullptr;
+    }
+
     // Verifica si una variable existe
-    bool check(const string& x) const {
-        return (search_rib(x) >= 0);
+    bool check(Symbol x) const {
+        return topOf(x) >= 0;
     }
 
     // Busca y devuelve el valor de una variable
     // Si no existe, devuelve un valor por defecto de T
-    T lookup(const string& x) const {
-        int idx = search_rib(x);
-        if (idx < 0) {
-            cerr << "[Advertencia] Variable no encontrada: " << x << endl;
-            return T(); // valor por defecto
-        }
-        return ribs[idx].at(x);
+    T lookup(Symbol x) const {
+        const T* v = find(x);
+        return v ? *v : T();
     }
 
     // Busca y devuelve el valor en una referencia. Devuelve true si existe.
-    bool lookup(const string& x, T& v) const {
-        int idx = search_rib(x);
-        if (idx < 0) return false;
-        v = ribs[idx].at(x);
+    bool lookup(Symbol x, T& v) const {
+        const T* found = find(x);
+        if (!found) return false;
+        v = *found;
         return true;
     }
 };
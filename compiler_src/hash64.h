@@ -0,0 +1,22 @@
+#ifndef HASH64_H
+#define HASH64_H
+
+#include <cstdint>
+#include <string_view>
+
+using namespace std;
+
+// FNV-1a de 64 bits, incremental
+struct Hash64 {
+    uint64_t h = 1469598103934665603ull;
+    void add(string_view s) {
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ull;
+        }
+        h ^= 0xff; // separador: "ab"+"c" != "a"+"bc"
+        h *= 1099511628211ull;
+    }
+};
+
+#endif // HASH64_H
@@ -0,0 +1,10 @@
+#include "interner.h"
+
+Symbol Interner::intern(string_view s) {
+    auto it = ids.find(s);
+    if (it != ids.end()) return it->second;
+    Symbol id = static_cast<Symbol>(names.size());
+    names.emplace_back(s);
+    ids.emplace(string_view(names.back()), id);
+    return id;
+}
@@ -0,0 +1,37 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+// internado de identificadores: el parser convierte cada nombre en un Symbol
+// (entero) una sola vez; el typechecker y el generador buscan por entero.
+// cada compilacion tiene el suyo (Program::names) y se libera con ella: los
+// simbolos de dos compilaciones no se mezclan y un daemon no acumula los
+// nombres de todo lo que compilo.
+// sin locks: solo el parser agrega nombres, y las fases en paralelo (tipos y
+// generacion) solo leen, despues de que el pool las separo del parseo.
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+using Symbol = int;
+
+class Interner {
+private:
+    unordered_map<string_view, Symbol> ids; // las vistas apuntan a names
+    deque<string> names;                    // deque: direcciones estables al crecer
+
+public:
+    Interner() = default;
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    // Devuelve el simbolo de s, creandolo si es nuevo
+    Symbol intern(string_view s);
+    // Nombre original del simbolo (la referencia es estable)
+    const string& name(Symbol s) const { return names.at(static_cast<size_t>(s)); }
+    size_t size() const { return names.size(); }
+};
+
+#endif // INTERNER_H
@@ -0,0 +1,82 @@
+#include "ir.h"
+
+using namespace std;
+
+bool irIsFloat(IrType t) { return t == IrType::F32; }
+bool irIs32(IrType t) { return t == IrType::I32 || t == IrType::U32; }
+bool irIsUnsigned(IrType t) { return t == IrType::U32 || t == IrType::U64; }
+
+IrType irTypeOf(const string& declared) {
+    if (declared == "bool") return IrType::BOOL;
+    if (declared == "int") return IrType::I32;
+    if (declared == "unsigned int") return IrType::U32;
+    if (declared == "float") return IrType::F32;
+    return IrType::I64; // long y por defecto
+}
+
+IrType irTypeOf(Type::TType t) {
+    switch (t) {
+        case Type::BOOL:  return IrType::BOOL;
+        case Type::INT:   return IrType::I32;
+        case Type::UINT:  return IrType::U32;
+        case Type::FLOAT: return IrType::F32;
+        default:          return IrType::I64;
+    }
+}
+
+int IrFunction::newTemp(IrType t) {
+    temps.push_back(t);
+    return (int)temps.size() - 1;
+}
+
+void IrFunction::buildCfg() {
+    for (IrBlock& b : blocks) {
+        b.succs.clear();
+        b.preds.clear();
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        IrBlock& b = blocks[i];
+        if (b.insts.empty() || !b.insts.back().isTerminator()) {
+            // sin terminador: cae al siguiente (solo el ultimo bloque puede quedar asi)
+            if (i + 1 < blocks.size()) b.succs.push_back((int)i + 1);
+            continue;
+        }
+        const IrInst& t = b.insts.back();
+        if (t.op == IR_JMP) b.succs.push_back(t.target);
+        else if (t.op == IR_BR) {
+            b.succs.push_back(t.target);
+            if (t.other != t.target) b.succs.push_back(t.other);
+        }
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        for (int s : blocks[i].succs) blocks[s].preds.push_back((int)i);
+    }
+}
+
+void IrFunction::reorderBlocks(const vector<int>& order) {
+    vector<int> nuevo(blocks.size(), -1);
+    vector<IrBlock> ordenados;
+    ordenados.reserve(order.size());
+    for (int b : order) {
+        nuevo[b] = (int)ordenados.size();
+        ordenados.push_back(std::move(blocks[b]));
+    }
+    for (IrBlock& blk : ordenados) {
+        for (IrInst& in : blk.insts) {
+            if (in.target >= 0) in.target = nuevo[in.target];
+            if (in.other >= 0) in.other = nuevo[in.other];
+            if (in.op != IR_PHI) continue;
+            // las entradas desde bloques descartados se van con ellos
+            size_t k = 0;
+            for (size_t i = 0; i < in.from.size(); ++i) {
+                if (nuevo[in.from[i]] < 0) continue;
+                in.from[k] = nuevo[in.from[i]];
+                in.args[k] = in.args[i];
+                ++k;
+            }
+            in.from.resize(k);
+            in.args.resize(k);
+        }
+    }
+    blocks = std::move(ordenados);
+}
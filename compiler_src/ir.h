@@ -0,0 +1,122 @@
+#ifndef IR_H
+#define IR_H
+// representacion intermedia de tres direcciones entre el ast y el asm.
+// cada funcion es una lista de bloques basicos con un grafo de control
+// explicito; las instrucciones operan sobre temporales tipados (numerados
+// desde 0 por funcion) y las variables solo se tocan con LOAD/STORE.
+// GenCodeVisitor baja cada FunDec a un IrFunction, ssa.h lo optimiza y
+// x86_backend lo traduce a un FunctionCode reubicable.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "interner.h"
+#include "semantic_types.h"
+#include "visitor.h"
+
+using namespace std;
+
+// tipo de un temporal u operacion. los enteros viven en registros de 64
+// bits: los de 32 bits van extendidos con ceros (lo que deja movl) y los
+// bool valen 0 o 1; pasar un I32 a 64 bits es un IR_CVT que extiende con
+// signo. U64 solo aparece como tipo de comparacion.
+enum class IrType : uint8_t { BOOL, I32, U32, I64, U64, F32 };
+
+bool irIsFloat(IrType t);
+bool irIs32(IrType t);      // operacion de 32 bits (I32, U32)
+bool irIsUnsigned(IrType t);
+IrType irTypeOf(const string& declared); // "int", "unsigned int", "long", "float", "bool"
+IrType irTypeOf(Type::TType t);
+
+// variable en memoria: local en el frame o global por nombre
+struct IrVar {
+    bool global = false;
+    Symbol sym = -1;
+    int offset = 0;             // locales: desplazamiento respecto de %rbp
+    IrType type = IrType::I32;  // tipo declarado: ancho del acceso a memoria
+};
+
+enum IrOp : uint8_t {
+    IR_CONST,  // dst = imm (F32: bits del float)
+    IR_LOAD,   // dst = var
+    IR_STORE,  // var = a
+    IR_ARG,    // dst = parametro entrante; imm = indice dentro de su clase (entero o float)
+    IR_ADD,    // dst = a op b, en el tipo type
+    IR_SUB,
+    IR_MUL,
+    IR_DIV,
+    IR_LT,     // dst (BOOL) = a < b comparando en el tipo type
+    IR_CVT,    // dst = a convertido de temps[a] a type (entre enteros: trunca al ancho de type; I32 se extiende con signo)
+    IR_COPY,   // dst = a
+    IR_CALL,   // dst = name(args); dst -1 si no se usa
+    IR_PRINT,  // printf(name, a); name es la etiqueta del formato
+    IR_SNAP,   // marca de snapshot: imm = indice local, name = etiqueta
+    IR_PHI,    // dst = args[i] si se llego desde el bloque from[i] (solo en ssa, al inicio del bloque)
+    // terminadores: siempre la ultima instruccion del bloque
+    IR_JMP,    // goto target
+    IR_BR,     // if (a != 0) goto target else goto other
+    IR_RET,    // return a (a -1: sin valor)
+};
+
+struct IrInst {
+    IrOp op;
+    IrType type = IrType::I64;
+    int dst = -1;
+    int a = -1;
+    int b = -1;
+    int64_t imm = 0;
+    IrVar var;            // LOAD, STORE
+    string name;          // CALL, PRINT, SNAP
+    vector<int> args;     // CALL, PHI
+    vector<int> from;     // PHI: bloque de origen de cada args[i]
+    int target = -1;      // JMP, BR
+    int other = -1;       // BR
+    int line = -2;        // linea fuente para asmByLine (-1 prologo, -2 sin linea)
+
+    bool isTerminator() const { return op == IR_JMP || op == IR_BR || op == IR_RET; }
+    // aplica fn(int&) a cada operando temporal (dst no cuenta)
+    template <class F>
+    void forEachUse(F fn) {
+        if (a >= 0) fn(a);
+        if (b >= 0) fn(b);
+        for (int& t : args) fn(t);
+    }
+    template <class F>
+    void forEachUse(F fn) const {
+        if (a >= 0) fn(a);
+        if (b >= 0) fn(b);
+        for (int t : args) fn(t);
+    }
+};
+
+struct IrBlock {
+    // etiqueta del asm (pre + numero local, ej. "while_" 3); label vacio si
+    // el bloque no la necesita. line es la linea fuente de la etiqueta.
+    string label;
+    int labelNum = -1;
+    int line = -2;
+    vector<IrInst> insts;
+    vector<int> succs; // llenados por buildCfg
+    vector<int> preds;
+};
+
+struct IrFunction {
+    string name;
+    vector<IrBlock> blocks;      // blocks[0] es la entrada; el orden es el del asm
+    vector<IrType> temps;        // tipo de cada temporal
+    vector<Snapshot> snapshots;  // indices locales, mismo orden que los IR_SNAP
+    int labelCount = 0;          // numeros de etiqueta locales usados
+    int prologLine = -2;         // linea del prologo y del guardado de parametros
+    int endLine = -2;            // linea del epilogo
+    int frameBottom = -8;        // primer offset libre debajo de las locales
+    const Interner* names = nullptr; // nombres de IrVar::sym (los del programa)
+
+    int newTemp(IrType t);
+    // recalcula succs/preds a partir de los terminadores
+    void buildCfg();
+    // deja los bloques en el orden dado (los que no aparecen se descartan)
+    // y renumera saltos y phis; hay que llamar a buildCfg despues
+    void reorderBlocks(const vector<int>& order);
+};
+
+#endif // IR_H
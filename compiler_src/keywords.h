@@ -0,0 +1,70 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+// tabla de palabras clave con hash perfecto armada en tiempo de compilacion.
+// el scanner clasifica un identificador con un solo acceso a la tabla y una
+// comparacion, sin crear strings temporales.
+
+#include <array>
+#include <string_view>
+#include "token.h"
+
+namespace keywords {
+
+struct Entry {
+    string_view text;
+    Token::Type type;
+};
+
+constexpr Entry kList[] = {
+    {"return",   Token::RETURN},
+    {"if",       Token::IF},
+    {"else",     Token::ELSE},
+    {"while",    Token::WHILE},
+    {"for",      Token::FOR},
+    {"do",       Token::DO},
+    {"printf",   Token::PRINT},
+    {"true",     Token::TRUE},
+    {"false",    Token::FALSE},
+    {"unsigned", Token::UNSIGNED},
+    {"int",      Token::INT},
+    {"float",    Token::FLOAT},
+    {"long",     Token::LONG},
+    {"auto",     Token::AUTO},
+};
+
+constexpr size_t kTableSize = 32; // potencia de 2: el modulo es un AND
+
+// hash sobre longitud, primer y ultimo caracter (libre de colisiones para kList)
+constexpr size_t hash(string_view s) {
+    return (s.size() + (static_cast<unsigned char>(s.front()) << 1) +
+            (static_cast<unsigned char>(s.back()) << 4)) & (kTableSize - 1);
+}
+
+constexpr array<Entry, kTableSize> buildTable() {
+    array<Entry, kTableSize> t{};
+    for (size_t i = 0; i < kTableSize; ++i) t[i] = Entry{string_view(), Token::ID};
+    for (const Entry& e : kList) t[hash(e.text)] = e;
+    return t;
+}
+
+constexpr array<Entry, kTableSize> kTable = buildTable();
+
+constexpr bool isPerfect() {
+    for (const Entry& e : kList) {
+        if (kTable[hash(e.text)].text != e.text) return false;
+    }
+    return true;
+}
+
+static_assert(isPerfect(), "colision en la tabla de palabras clave: ajustar keywords::hash");
+
+// Devuelve el tipo de palabra clave o Token::ID si lex es un identificador comun.
+constexpr Token::Type lookup(string_view lex) {
+    if (lex.size() < 2 || lex.size() > 8) return Token::ID; // fuera del rango de longitudes
+    const Entry& e = kTable[hash(lex)];
+    return (e.text == lex) ? e.type : Token::ID;
+}
+
+} // namespace keywords
+
+#endif // KEYWORDS_H
@@ -1,57 +1,290 @@
 #include <iostream>
 #include <fstream>
 #include <string>
-#include "scanner.h"
-#include "parser.h"
-#include "ast.h"
-#include "visitor.h"
-#include "TypeChecker.h"
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <map>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "source_buffer.h"
+#include "cache.h"
+#include "compi.h"
+#include "daemon.h"
+#include "session.h"
+#include "thread_pool.h"
 
 using namespace std;
 
-// flujo principal: leer fuente, tokenizar, parsear, verificar tipos y generar asm + snapshots
+// nombre sin extension: base del .s y de los json (un punto en un
+// directorio no es extension)
+static string baseNameOf(const string& inputFile) {
+    size_t dotPos = inputFile.find_last_of('.');
+    size_t slashPos = inputFile.find_last_of('/');
+    if (dotPos == string::npos || (slashPos != string::npos && dotPos < slashPos)) return inputFile;
+    return inputFile.substr(0, dotPos);
+}
+
+// path con el directorio resuelto por realpath (tal cual si no existe), para
+// comparar rutas escritas distinto: "./a.txt", "a.txt", "dir/../a.txt"
+static string canonicalPath(const string& path) {
+    size_t slash = path.find_last_of('/');
+    string dir = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    string name = slash == string::npos ? path : path.substr(slash + 1);
+    char* real = realpath(dir.c_str(), nullptr);
+    if (!real) return path;
+    string res = string(real) + "/" + name;
+    free(real);
+    return res;
+}
+
+// '@lista' se expande a las rutas de ese archivo, una por linea (se saltan
+// las vacias y las que empiezan con '#')
+static bool expandInputs(int argc, const char* argv[], vector<string>& files) {
+    for (int i = 1; i < argc; ++i) {
+        string arg(argv[i]);
+        if (arg.empty() || arg[0] != '@') {
+            files.push_back(arg);
+            continue;
+        }
+        ifstream manifest(arg.substr(1));
+        if (!manifest.is_open()) {
+            cout << "no se pudo abrir la lista: " << arg.substr(1) << endl;
+            return false;
+        }
+        string line;
+        while (getline(manifest, line)) {
+            while (!line.empty() && isspace((unsigned char)line.back())) line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
+            files.push_back(line);
+        }
+    }
+    return true;
+}
+
+// entradas que escribirian el mismo .s y los mismos json: el mismo archivo
+// repetido (se compila la primera vez, las demas son error) o archivos
+// distintos con la misma base, como a.txt y a.c (ninguno se compila: no
+// hay cual elegir). devuelve el motivo por entrada ("" si no choca).
+static vector<string> findOutputConflicts(const vector<string>& files) {
+    vector<string> conflict(files.size());
+    map<string, vector<size_t>> byOutput;
+    for (size_t i = 0; i < files.size(); ++i) byOutput[baseNameOf(canonicalPath(files[i]))].push_back(i);
+    for (auto& entry : byOutput) {
+        const vector<size_t>& same = entry.second;
+        if (same.size() < 2) continue;
+        string first = canonicalPath(files[same[0]]);
+        bool repeated = all_of(same.begin(), same.end(), [&](size_t i) { return canonicalPath(files[i]) == first; });
+        if (repeated) {
+            for (size_t k = 1; k < same.size(); ++k) {
+                conflict[same[k]] = "repetido en la lista (ya esta como " + files[same[0]] + ")";
+            }
+            continue;
+        }
+        for (size_t i : same) {
+            string others;
+            for (size_t j : same) {
+                if (j != i) others += (others.empty() ? "" : ", ") + files[j];
+            }
+            conflict[i] = "su salida " + baseNameOf(files[i]) + ".s tambien la escribe " + others;
+        }
+    }
+    return conflict;
+}
+
+// modo por lotes: cada archivo es una tarea del pool y se compila entero en
+// un hilo (los cuerpos se verifican en secuencia dentro de la tarea). los
+// hilos toman el siguiente archivo libre, asi uno grande no frena al resto.
+// el resumen sale en el orden de entrada cuando terminaron todos.
+static int compileBatch(const vector<string>& files, unsigned jobs, ArtifactCache* cache) {
+    struct Status {
+        bool opened = false;
+        bool ok = false;
+        string diagnostics;
+    };
+    vector<Status> status(files.size());
+    // otra entrada escribe la misma salida: no se compila
+    vector<string> conflict = findOutputConflicts(files);
+    auto start = chrono::steady_clock::now();
+
+    ThreadPool pool(jobs);
+    pool.parallelFor(files.size(), [&](size_t i, unsigned) {
+        if (!conflict[i].empty()) return;
+        SourceBuffer source;
+        if (!source.open(files[i])) return;
+        status[i].opened = true;
+        CompileOptions options;
+        options.cache = cache;
+        CompileResult result;
+        // parallelFor no admite que fn lance: un error inesperado queda como
+        // diagnostico de este archivo
+        try {
+            result = compile(source.view(), options);
+        } catch (const exception& e) {
+            status[i].diagnostics = string("error interno: ") + e.what() + "\n";
+            remove((baseNameOf(files[i]) + ".s").c_str());
+            return;
+        }
+        string baseName = baseNameOf(files[i]);
+        if (!result.ok) {
+            status[i].diagnostics = result.diagnostics.render();
+            remove((baseName + ".s").c_str()); // no dejar el .s de otra corrida
+            return;
+        }
+        ofstream(baseName + ".s", ios::trunc) << result.assembly;
+        ofstream(baseName + "_stack.json", ios::trunc) << result.stackJson;
+        ofstream(baseName + "_stack.json.asm.json", ios::trunc) << result.asmMapJson;
+        status[i].ok = true;
+    });
+
+    auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    size_t ok = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        const Status& s = status[i];
+        if (s.ok) {
+            ++ok;
+            cout << "ok     " << files[i] << "\n";
+        } else if (!conflict[i].empty()) {
+            cout << "error  " << files[i] << ": " << conflict[i] << "\n";
+        } else if (!s.opened) {
+            cout << "error  " << files[i] << ": no se pudo abrir el archivo\n";
+        } else {
+            cout << "error  " << files[i] << "\n";
+            // diagnosticos indentados bajo su archivo
+            size_t from = 0;
+            while (from < s.diagnostics.size()) {
+                size_t nl = s.diagnostics.find('\n', from);
+                if (nl == string::npos) nl = s.diagnostics.size();
+                cout << "       " << s.diagnostics.substr(from, nl - from) << "\n";
+                from = nl + 1;
+            }
+        }
+    }
+    cout << files.size() << " archivos: " << ok << " ok, " << files.size() - ok
+         << " con errores en " << ms << " ms (" << pool.size() << " hilos)" << endl;
+    return ok == files.size() ? 0 : 1;
+}
+
+// linea de comandos sobre libcompi: compila un archivo y deja el .s y los json al lado
 int main(int argc, const char* argv[]) {
-    if (argc != 2) {
+    // --session <archivo>: modo incremental, reutiliza funciones sin cambios
+    // de la compilacion anterior guardada en ese archivo
+    // -j <n>: hilos para verificar cuerpos (por defecto uno por nucleo)
+    // --daemon <socket|->: servidor de compilacion (ver daemon.h); -j fija
+    // cuantos pedidos se compilan a la vez
+    // --cache <dir>: cache de artefactos por contenido (ver cache.h), con
+    // --cache-max <MB> como limite de tamaño
+    // varios archivos (o @lista): modo por lotes, un archivo por tarea y -j
+    // archivos a la vez
+    string sessionPath;
+    string daemonPath;
+    string cachePath;
+    uint64_t cacheMax = ArtifactCache::DEFAULT_MAX_BYTES;
+    unsigned jobs = 0;
+    while (argc >= 3) {
+        string opt(argv[1]);
+        if (opt == "--session") sessionPath = argv[2];
+        else if (opt == "-j") jobs = (unsigned)max(1, atoi(argv[2]));
+        else if (opt == "--daemon") daemonPath = argv[2];
+        else if (opt == "--cache") cachePath = argv[2];
+        else if (opt == "--cache-max") cacheMax = (uint64_t)max(1, atoi(argv[2])) << 20;
+        else break;
+        argv += 2;
+        argc -= 2;
+    }
+    unique_ptr<ArtifactCache> cache;
+    if (!cachePath.empty()) cache.reset(new ArtifactCache(cachePath, cacheMax));
+    if (!daemonPath.empty() && argc == 1) return runDaemon(daemonPath, jobs, cache.get());
+    if (argc < 2 || !daemonPath.empty()) {
         cout << "numero incorrecto de argumentos\n";
-        cout << "uso: " << argv[0] << " <archivo_de_entrada>" << endl;
+        cout << "uso: " << argv[0] << " [--session <estado>] [--cache <dir>] [-j <hilos>] <archivo_de_entrada>" << endl;
+        cout << "     " << argv[0] << " [--cache <dir>] [-j <hilos>] <archivo>... | @lista" << endl;
+        cout << "     " << argv[0] << " --daemon <socket|-> [--cache <dir>] [-j <workers>]" << endl;
         return 1;
     }
+    if (argc > 2 || argv[1][0] == '@') {
+        if (!sessionPath.empty()) {
+            cout << "--session compila un solo archivo" << endl;
+            return 1;
+        }
+        vector<string> files;
+        if (!expandInputs(argc, argv, files)) return 1;
+        return compileBatch(files, jobs, cache.get());
+    }
 
-    ifstream infile(argv[1]);
-    if (!infile.is_open()) {
+    // el archivo se mapea en memoria; los tokens apuntan directo al buffer
+    SourceBuffer source;
+    if (!source.open(argv[1])) {
         cout << "no se pudo abrir el archivo: " << argv[1] << endl;
         return 1;
     }
 
-    string input, line;
-    while (getline(infile, line)) {
-        input += line + '\n';
-    }
-    infile.close();
+    string baseName = baseNameOf(argv[1]);
+    string outputFilename = baseName + ".s";
+    string stackFilename = baseName + "_stack.json";
 
-    Scanner scanner1(input.c_str());
-    Parser parser(&scanner1);
-    Program* program = parser.parseProgram();
+    CompileSession session;
+    bool incremental = !sessionPath.empty();
+    if (incremental) session.load(sessionPath);
 
-    string inputFile(argv[1]);
-    size_t dotPos = inputFile.find_last_of('.');
-    string baseName = (dotPos == string::npos) ? inputFile : inputFile.substr(0, dotPos);
-    string outputFilename = baseName + ".s";
+    // el asm se escribe en el .s funcion por funcion mientras se compila
     ofstream outfile(outputFilename);
     if (!outfile.is_open()) {
         cerr << "error al crear el archivo de salida: " << outputFilename << endl;
         return 1;
     }
-
     cout << "\n=== verificacion de tipos ===\n";
-    TypeChecker tc;
-    tc.typecheck(program);
-
     cout << "generando asm en " << outputFilename << endl;
-    string stackFilename = baseName + "_stack.json";
-    GenCodeVisitor codigo(outfile, stackFilename);
-    codigo.generar(program);
+
+    ThreadPool pool(jobs);
+    CompileOptions options;
+    options.pool = &pool;
+    options.session = incremental ? &session : nullptr;
+    options.cache = cache.get();
+    options.asmOut = &outfile;
+    CompileResult result;
+    try {
+        result = compile(source.view(), options);
+    } catch (...) {
+        outfile.close();
+        remove(outputFilename.c_str());
+        throw;
+    }
     outfile.close();
-    
+    if (!result.ok) {
+        // no dejar un .s a medias
+        cerr << result.diagnostics.render();
+        remove(outputFilename.c_str());
+        return 1;
+    }
+    cout << "Revisión exitosa" << endl;
+
+    ofstream(stackFilename, ios::trunc) << result.stackJson;
+    ofstream(stackFilename + ".asm.json", ios::trunc) << result.asmMapJson;
+    if (result.peephole.total() > 0) {
+        const EstadisticasPeephole& ph = result.peephole;
+        cout << "peephole: " << ph.total() << " reescrituras, hasta " << ph.pasadas << " pasadas por funcion (";
+        const char* sep = "";
+        for (int r = 0; r < P_CANTIDAD; ++r) {
+            if (!ph.reescrituras[r]) continue;
+            cout << sep << nombreReglaPeephole(ReglaPeephole(r)) << " " << ph.reescrituras[r];
+            sep = ", ";
+        }
+        cout << ")" << endl;
+    }
+    if (cache && !incremental) {
+        CacheStats st = cache->stats();
+        cout << "cache: " << st.hits << " aciertos, " << st.misses << " fallos, "
+             << st.evictions << " desalojos, " << (st.bytes >> 10) << " KB de "
+             << (cacheMax >> 10) << " KB" << endl;
+    }
+    if (incremental) {
+        cout << "incremental: " << session.reused << " funciones reutilizadas, "
+             << session.rebuilt << " recompiladas" << endl;
+        session.save(sessionPath);
+    }
     return 0;
 }
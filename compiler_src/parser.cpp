@@ -1,6 +1,13 @@
 #include "parser.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace std;
 
@@ -8,30 +15,62 @@ using namespace std;
 // Constructor y helpers
 // =============================
 
-Parser::Parser(Scanner* sc) : scanner(sc), current(nullptr), previous(nullptr) {
-    current = scanner->nextToken();
-    if (current->type == Token::ERR) {
-        throw runtime_error("Error léxico al iniciar el parser");
+Parser::Parser(Scanner* sc, Diagnostics& d) : scanner(sc), stream(nullptr), streamPos(0), head(0), filled(1), arena(nullptr), names(nullptr), deferBodies(false), diags(&d) {
+    init();
+}
+
+Parser::Parser(const TokenStream* ts, Diagnostics& d) : scanner(nullptr), stream(ts), streamPos(0), head(0), filled(1), arena(nullptr), names(nullptr), deferBodies(false), diags(&d) {
+    init();
+}
+
+void Parser::init() {
+    ring[head] = fetch();
+    ring[(head - 1) & RING_MASK] = Token(Token::END, 0, 0); // aun no hay previous
+    if (current().type == Token::ERR) lexError();
+}
+
+void Parser::seek(size_t pos) {
+    streamPos = pos;
+    head = 0;
+    filled = 1;
+    init();
+}
+
+Token Parser::fetch() {
+    if (stream) return stream->at(streamPos++);
+    return scanner->nextToken();
+}
+
+const Token& Parser::peek(int k) {
+    if (k < 0 || k >= MAX_LOOKAHEAD) {
+        throw runtime_error("Lookahead fuera de rango");
+    }
+    // rellenar el ring desde el scanner hasta tener k+1 tokens por delante
+    while (filled <= k) {
+        const Token& last = ring[(head + filled - 1) & RING_MASK];
+        if (last.type == Token::END) return last; // no leer mas alla de EOF
+        ring[(head + filled) & RING_MASK] = fetch();
+        ++filled;
     }
+    return ring[(head + k) & RING_MASK];
 }
 
 bool Parser::isAtEnd() const {
-    return current->type == Token::END;
+    return current().type == Token::END;
 }
 
 bool Parser::check(Token::Type ttype) const {
     if (isAtEnd()) return false;
-    return current->type == ttype;
+    return current().type == ttype;
 }
 
 bool Parser::advance() {
     if (!isAtEnd()) {
-        Token* temp = current;
-        previous = temp;
-        current = scanner->nextToken();
-        if (current->type == Token::ERR) {
-            throw runtime_error("Error léxico");
-        }
+        // el slot de current pasa a ser previous; no hay copias ni delete
+        peek(1);
+        head = (head + 1) & RING_MASK;
+        --filled;
+        if (current().type == Token::ERR) lexError();
         return true;
     }
     return false;
@@ -46,8 +85,22 @@ bool Parser::match(Token::Type ttype) {
 }
 
 void Parser::error(const string& msg) {
-    cerr << "Error de parseo: " << msg << endl;
-    throw runtime_error(msg);
+    diags->error("parseo", current().line, current().col, msg);
+    throw CompileError(msg);
+}
+
+void Parser::literalError(const string& lex) {
+    const Token& t = previous();
+    string msg = "literal numerico fuera de rango '" + lex + "'";
+    diags->error("parseo", t.line, t.col, msg);
+    throw CompileError(msg);
+}
+
+void Parser::lexError() {
+    const Token& t = current();
+    string msg = t.text.empty() ? "simbolo inesperado" : "simbolo inesperado '" + string(t.text) + "'";
+    diags->error("lexico", t.line, t.col, msg);
+    throw CompileError(msg);
 }
 
 // =============================
@@ -92,6 +145,8 @@ TypeKind Parser::parseTypeSpec(string& outType) {
 
 Program* Parser::parseProgram() {
     Program* prog = new Program();
+    arena = &prog->arena; // todos los nodos se reservan en el arena del programa
+    names = &prog->names;
 
     while (!isAtEnd()) {
         if (check(Token::END)) break;
@@ -102,6 +157,57 @@ Program* Parser::parseProgram() {
     return prog;
 }
 
+Program* Parser::parseDeclarations() {
+    if (!stream) {
+        throw runtime_error("parseDeclarations requiere un TokenStream");
+    }
+    deferBodies = true;
+    Program* prog = parseProgram();
+    deferBodies = false;
+    return prog;
+}
+
+Body* Parser::parseFunctionBody(FunDec* fd, Arena& into) {
+    if (fd->cuerpo) return fd->cuerpo;
+    Arena* saved = arena;
+    arena = &into;
+    seek(fd->bodyBegin);
+    fd->cuerpo = parseBody();
+    arena = saved;
+    return fd->cuerpo;
+}
+
+vector<FunDec*> Parser::reachableFrom(Program* prog, const string& root) const {
+    unordered_map<string_view, FunDec*> byName;
+    for (FunDec* fd : prog->fdlist) byName.emplace(fd->nombre, fd);
+    auto it = byName.find(root);
+    if (!stream || it == byName.end()) {
+        return vector<FunDec*>(prog->fdlist.begin(), prog->fdlist.end());
+    }
+
+    // recorrido del grafo de llamadas; un cuerpo ya parseado tambien se
+    // recorre por su rango de tokens
+    unordered_set<FunDec*> seen{it->second};
+    vector<FunDec*> work{it->second};
+    while (!work.empty()) {
+        FunDec* fd = work.back();
+        work.pop_back();
+        for (size_t i = fd->bodyBegin; i + 1 < fd->bodyEnd; ++i) {
+            if (stream->kind[i] != Token::ID || stream->kind[i + 1] != Token::LPAREN) continue;
+            auto callee = byName.find(stream->source.substr(stream->offset[i], stream->length[i]));
+            if (callee != byName.end() && seen.insert(callee->second).second) {
+                work.push_back(callee->second);
+            }
+        }
+    }
+
+    vector<FunDec*> out;
+    for (FunDec* fd : prog->fdlist) {
+        if (seen.count(fd)) out.push_back(fd);
+    }
+    return out;
+}
+
 // =============================
 // Declaraciones de nivel superior
 // =============================
@@ -119,19 +225,20 @@ void Parser::parseTopLevelDeclaration(Program* prog) {
 
     string typeName;
     TypeKind kind = parseTypeSpec(typeName);
-    int declLine = previous ? previous->line : 0;
+    int declLine = previous().line;
 
     if (!match(Token::ID)) {
         error("Se esperaba identificador después del tipo");
     }
-    string name = previous->text;
+    string_view name = previous().text;
 
     if (check(Token::LPAREN)) {
         // Declaración de función
-        FunDec* fd = new FunDec();
+        FunDec* fd = arena->make<FunDec>();
         fd->kind   = kind;
         fd->type   = typeName;
-        fd->nombre = name;
+        fd->nombre = string(name);
+        fd->line   = previous().line;
 
         match(Token::LPAREN);
         if (!check(Token::RPAREN)) {
@@ -141,14 +248,33 @@ void Parser::parseTopLevelDeclaration(Program* prog) {
             error("Se esperaba ')' al final de la lista de parámetros");
         }
 
-        fd->cuerpo = parseBody();
+        if (deferBodies && check(Token::LBRACE)) {
+            // solo delimitar el cuerpo: llaves balanceadas sobre los kinds del
+            // stream, sin construir tokens. los errores dentro del cuerpo salen
+            // cuando se parsea con parseFunctionBody.
+            size_t i = position();
+            fd->bodyBegin = i;
+            int depth = 0;
+            for (; i < stream->size(); ++i) {
+                Token::Type k = static_cast<Token::Type>(stream->kind[i]);
+                if (k == Token::END) break;
+                if (k == Token::LBRACE) ++depth;
+                else if (k == Token::RBRACE && --depth == 0) { ++i; break; }
+            }
+            fd->bodyEnd = i;
+            seek(i);
+        } else {
+            if (stream) fd->bodyBegin = position();
+            fd->cuerpo = parseBody();
+            if (stream) fd->bodyEnd = position();
+        }
         prog->fdlist.push_back(fd);
     } else {
         // Declaración de variable global: ya consumimos el primer ID
-        VarDec* vd = new VarDec(declLine);
+        VarDec* vd = arena->make<VarDec>(declLine);
         vd->kind = kind;
         vd->type = typeName;
-        vd->vars.push_back(name);
+        vd->vars.push_back(names->intern(name));
         vd->initializers.push_back(nullptr);
 
         // Más variables en la misma línea
@@ -156,7 +282,7 @@ void Parser::parseTopLevelDeclaration(Program* prog) {
             if (!match(Token::ID)) {
                 error("Se esperaba identificador después de ',' en una declaración global");
             }
-            vd->vars.push_back(previous->text);
+            vd->vars.push_back(names->intern(previous().text));
             vd->initializers.push_back(nullptr);
         }
 
@@ -183,7 +309,7 @@ void Parser::parseParamList(FunDec* fd) {
         }
 
         fd->Ptipos.push_back(ptype);
-        fd->Pnombres.push_back(previous->text);
+        fd->Pnombres.push_back(names->intern(previous().text));
 
         if (!match(Token::COMA)) break;
     }
@@ -194,15 +320,15 @@ void Parser::parseParamList(FunDec* fd) {
 // =============================
 
 VarDec* Parser::parseTypedVariableDeclaration() {
-    VarDec* vd = new VarDec();
+    VarDec* vd = arena->make<VarDec>();
     vd->kind = parseTypeSpec(vd->type);
-    vd->line = previous ? previous->line : 0;
+    vd->line = previous().line;
 
     // primer identificador
     if (!match(Token::ID)) {
         error("Se esperaba identificador en declaración de variable");
     }
-    vd->vars.push_back(previous->text);
+    vd->vars.push_back(names->intern(previous().text));
 
     if (match(Token::ASSIGN)) {
         vd->initializers.push_back(parseExpression());
@@ -215,7 +341,7 @@ VarDec* Parser::parseTypedVariableDeclaration() {
         if (!match(Token::ID)) {
             error("Se esperaba identificador después de ',' en declaración de variable");
         }
-        vd->vars.push_back(previous->text);
+        vd->vars.push_back(names->intern(previous().text));
         if (match(Token::ASSIGN)) {
             vd->initializers.push_back(parseExpression());
         } else {
@@ -231,10 +357,10 @@ VarDec* Parser::parseTypedVariableDeclaration() {
 }
 
 VarDec* Parser::parseAutoDeclaration() {
-    VarDec* vd = new VarDec();
+    VarDec* vd = arena->make<VarDec>();
     vd->kind = TYPE_AUTO;
     vd->type = "auto";
-    vd->line = current ? current->line : 0;
+    vd->line = current().line;
 
     if (!match(Token::AUTO)) {
         error("Se esperaba 'auto'");
@@ -244,7 +370,7 @@ VarDec* Parser::parseAutoDeclaration() {
     if (!match(Token::ID)) {
         error("Se esperaba identificador después de 'auto'");
     }
-    vd->vars.push_back(previous->text);
+    vd->vars.push_back(names->intern(previous().text));
 
     if (!match(Token::ASSIGN)) {
         error("Se esperaba '=' en declaración con auto");
@@ -255,7 +381,7 @@ VarDec* Parser::parseAutoDeclaration() {
         if (!match(Token::ID)) {
             error("Se esperaba identificador después de ',' en declaración con auto");
         }
-        vd->vars.push_back(previous->text);
+        vd->vars.push_back(names->intern(previous().text));
         if (!match(Token::ASSIGN)) {
             error("Se esperaba '=' en declaración con auto");
         }
@@ -278,7 +404,7 @@ Body* Parser::parseBody() {
         error("Se esperaba '{' al inicio de un bloque");
     }
 
-    Body* body = new Body();
+    Body* body = arena->make<Body>();
 
     while (!check(Token::RBRACE) && !isAtEnd()) {
         if (check(Token::AUTO)) {
@@ -318,13 +444,13 @@ void Parser::parseForIntoBody(Body* body) {
 
     string itype;
     TypeKind ikind = parseTypeSpec(itype);
-    int declLine = previous ? previous->line : 0;
+    int declLine = previous().line;
 
     if (!match(Token::ID)) {
         error("Se esperaba identificador en la inicialización del for");
     }
-    string varName = previous->text;
-    int initLine = previous ? previous->line : declLine;
+    Symbol varName = names->intern(previous().text);
+    int initLine = previous().line;
 
     if (!match(Token::ASSIGN)) {
         error("Se esperaba '=' en la inicialización del for");
@@ -336,7 +462,7 @@ void Parser::parseForIntoBody(Body* body) {
     }
 
     // Añadimos 'int i;' a las declaraciones del bloque (para reservar espacio)
-    VarDec* vd = new VarDec(declLine);
+    VarDec* vd = arena->make<VarDec>(declLine);
     vd->kind = ikind;
     vd->type = itype;
     vd->vars.push_back(varName);
@@ -344,13 +470,13 @@ void Parser::parseForIntoBody(Body* body) {
     body->declarations.push_back(vd);
 
     // Sentencia de inicialización (no la metemos directo al Body, la guardamos en el ForStm)
-    Stm* initStm = new AssignStm(varName, initExp, initLine);
+    Stm* initStm = arena->make<AssignStm>(varName, initExp, initLine);
 
     // 2) Condición: for (int i = ...; i < expr; ...)
     if (!match(Token::ID)) {
         error("Se esperaba identificador en la condición del for");
     }
-    string condVar = previous->text;
+    Symbol condVar = names->intern(previous().text);
 
     if (!match(Token::LE)) {
         error("Por ahora solo se soporta condición 'var < expr' en for");
@@ -366,8 +492,8 @@ void Parser::parseForIntoBody(Body* body) {
     if (!match(Token::ID)) {
         error("Se esperaba identificador en el incremento del for");
     }
-    string stepVar = previous->text;
-    int stepLine = previous ? previous->line : declLine;
+    Symbol stepVar = names->intern(previous().text);
+    int stepLine = previous().line;
 
     if (!match(Token::PLUS) || !match(Token::PLUS)) {
         error("Por ahora solo se soporta incremento 'var++' en for");
@@ -383,22 +509,22 @@ void Parser::parseForIntoBody(Body* body) {
         loopBody = parseBody();
     } else {
         Stm* only = parseStatement();
-        loopBody = new Body();
+        loopBody = arena->make<Body>();
         if (only) loopBody->StmList.push_back(only);
     }
 
     // Construimos la sentencia de paso: i = i + 1;
-    Exp* stepLeft = new IdExp(stepVar);
-    Exp* one      = new NumberExp(1, 1.0, false, false, false);
-    Exp* plusExpr = new BinaryExp(stepLeft, one, PLUS_OP);
-    Stm* stepStm  = new AssignStm(stepVar, plusExpr, stepLine);
+    Exp* stepLeft = arena->make<IdExp>(stepVar);
+    Exp* one      = arena->make<NumberExp>(1, 1.0, false, false, false);
+    Exp* plusExpr = arena->make<BinaryExp>(stepLeft, one, PLUS_OP);
+    Stm* stepStm  = arena->make<AssignStm>(stepVar, plusExpr, stepLine);
 
     // Condición del for: i < expr  => BinaryExp(IdExp(condVar), condRight, LE_OP)
-    Exp* condLeft = new IdExp(condVar);
-    Exp* condExpr = new BinaryExp(condLeft, condRight, LE_OP);
+    Exp* condLeft = arena->make<IdExp>(condVar);
+    Exp* condExpr = arena->make<BinaryExp>(condLeft, condRight, LE_OP);
 
     // Creamos el nodo ForStm y lo agregamos como sentencia del bloque
-    ForStm* f = new ForStm(initStm, condExpr, stepStm, loopBody, declLine);
+    ForStm* f = arena->make<ForStm>(initStm, condExpr, stepStm, loopBody, declLine);
     body->StmList.push_back(f);
 }
 
@@ -424,7 +550,7 @@ Stm* Parser::parseStatement() {
 
 Stm* Parser::parseIfStatement() {
     match(Token::IF);
-    int lineNo = previous ? previous->line : 0;
+    int lineNo = previous().line;
     if (!match(Token::LPAREN)) {
         error("Se esperaba '(' después de 'if'");
     }
@@ -439,7 +565,7 @@ Stm* Parser::parseIfStatement() {
         thenBody = parseBody();
     } else {
         Stm* thenStm = parseStatement();
-        thenBody = new Body();
+        thenBody = arena->make<Body>();
         if (thenStm) thenBody->StmList.push_back(thenStm);
     }
 
@@ -449,17 +575,17 @@ Stm* Parser::parseIfStatement() {
             elseBody = parseBody();
         } else {
             Stm* elseStm = parseStatement();
-            elseBody = new Body();
+            elseBody = arena->make<Body>();
             if (elseStm) elseBody->StmList.push_back(elseStm);
         }
     }
 
-    return new IfStm(cond, thenBody, elseBody, lineNo);
+    return arena->make<IfStm>(cond, thenBody, elseBody, lineNo);
 }
 
 Stm* Parser::parseWhileStatement() {
     match(Token::WHILE);
-    int lineNo = previous ? previous->line : 0;
+    int lineNo = previous().line;
     if (!match(Token::LPAREN)) {
         error("Se esperaba '(' después de 'while'");
     }
@@ -473,31 +599,31 @@ Stm* Parser::parseWhileStatement() {
         b = parseBody();
     } else {
         Stm* s = parseStatement();
-        b = new Body();
+        b = arena->make<Body>();
         if (s) b->StmList.push_back(s);
     }
 
-    return new WhileStm(cond, b, lineNo);
+    return arena->make<WhileStm>(cond, b, lineNo);
 }
 
 Stm* Parser::parseReturnStatement() {
     match(Token::RETURN);
-    int lineNo = previous ? previous->line : 0;
+    int lineNo = previous().line;
     if (check(Token::SEMICOL)) {
         match(Token::SEMICOL);
-        return new ReturnStm(nullptr, lineNo);
+        return arena->make<ReturnStm>(nullptr, lineNo);
     } else {
         Exp* e = parseExpression();
         if (!match(Token::SEMICOL)) {
             error("Se esperaba ';' después de return");
         }
-        return new ReturnStm(e, lineNo);
+        return arena->make<ReturnStm>(e, lineNo);
     }
 }
 
 Stm* Parser::parsePrintStatement() {
     match(Token::PRINT);
-    int lineNo = previous ? previous->line : 0;
+    int lineNo = previous().line;
     if (!match(Token::LPAREN)) {
         error("Se esperaba '(' después de printf");
     }
@@ -519,15 +645,15 @@ Stm* Parser::parsePrintStatement() {
         error("Se esperaba ';' después de printf");
     }
 
-    return new PrintStm(arg, lineNo);
+    return arena->make<PrintStm>(arg, lineNo);
 }
 
 Stm* Parser::parseAssignOrExprStatement() {
     if (!match(Token::ID)) {
         error("Se esperaba identificador al inicio de la sentencia");
     }
-    string name = previous->text;
-    int lineNo = previous ? previous->line : 0;
+    Symbol name = names->intern(previous().text);
+    int lineNo = previous().line;
 
     if (!match(Token::ASSIGN)) {
         error("Por ahora solo se soportan sentencias de asignación tipo 'id = expr;'");
@@ -539,166 +665,242 @@ Stm* Parser::parseAssignOrExprStatement() {
         error("Se esperaba ';' al final de la sentencia de asignación");
     }
 
-    return new AssignStm(name, rhs, lineNo);
+    return arena->make<AssignStm>(name, rhs, lineNo);
 }
 
 // =============================
 // Expresiones
 // =============================
-
-Exp* Parser::parseExpression() {
-    return parseTernary();
+// parser de precedencia (Pratt) guiado por tabla y con pilas explicitas:
+// no hay recursion nativa por nivel de precedencia, ni por '-' unario,
+// ni por parentesis o argumentos, asi que expresiones largas o muy
+// anidadas se parsean en tiempo lineal sin crecer la pila de C++.
+//
+//   expression : comparison ( '?' comparison ':' comparison )?
+//   comparison : additive ( ('<' | '>') additive )*
+//   additive   : term ( ('+' | '-') term )*
+//   term       : factor ( ('*' | '/') factor )*
+//   factor     : '-' factor | primary
+
+namespace {
+
+const int PREC_UNARY = 4; // '-' prefijo liga mas fuerte que cualquier binario
+
+struct BinaryRule {
+    BinaryOp op;
+    int prec;  // 0 = no es operador binario
+    bool swap; // a > b se construye como b < a
+};
+
+constexpr array<BinaryRule, Token::ERR + 1> buildBinaryRules() {
+    array<BinaryRule, Token::ERR + 1> t{};
+    for (auto& r : t) r = BinaryRule{PLUS_OP, 0, false};
+    t[Token::LE]    = BinaryRule{LE_OP,    1, false};
+    t[Token::GT]    = BinaryRule{LE_OP,    1, true};
+    t[Token::PLUS]  = BinaryRule{PLUS_OP,  2, false};
+    t[Token::MINUS] = BinaryRule{MINUS_OP, 2, false};
+    t[Token::MUL]   = BinaryRule{MUL_OP,   3, false};
+    t[Token::DIV]   = BinaryRule{DIV_OP,   3, false};
+    return t;
 }
 
-Exp* Parser::parseTernary() {
-    // condición:  lo que ya soporta comparison (<, >, +, -, *, /, etc.)
-    Exp* condition = parseComparison();
-
-    // ¿hay operador ternario?
-    if (match(Token::QMARK)) {
-        // parte "then"
-        Exp* thenExp = parseComparison();
-
-        if (!match(Token::COL)) {
-            error("Se esperaba ':' en la expresión condicional ternaria");
+constexpr array<BinaryRule, Token::ERR + 1> kBinaryRules = buildBinaryRules();
+
+struct PendingOp {
+    BinaryRule rule;
+    bool unary;
+};
+
+// contexto de expresion abierto (en vez de un frame de recursion)
+struct ExprContext {
+    enum Kind {
+        TOP,    // expresion pedida por el llamador
+        GROUP,  // '(' expression ')'
+        ARG,    // argumento de llamada: expression (',' | ')')
+        THEN,   // rama then del ternario: comparison ':'
+        ELSE    // rama else del ternario: comparison
+    } kind;
+    size_t valBase;  // operandos propios empiezan aqui
+    size_t opBase;   // operadores propios empiezan aqui
+    size_t argBase;  // ARG: primer argumento ya parseado en la pila de valores
+    string_view callee;
+    Exp* cond;       // THEN/ELSE
+    Exp* thenExp;    // ELSE
+};
+
+} // namespace
+
+// reduce los operadores del contexto con precedencia >= minPrec
+static void reduceOps(Arena* arena, vector<Exp*>& vals, vector<PendingOp>& ops, size_t opBase, int minPrec) {
+    while (ops.size() > opBase && ops.back().rule.prec >= minPrec) {
+        PendingOp top = ops.back();
+        ops.pop_back();
+        Exp* right = vals.back();
+        vals.pop_back();
+        if (top.unary) {
+            // -x se representa como 0 - x
+            vals.push_back(arena->make<BinaryExp>(arena->make<NumberExp>(0, 0.0, false, false, false), right, MINUS_OP));
+            continue;
         }
-
-        // parte "else"
-        Exp* elseExp = parseComparison();
-
-        return new TernaryExp(condition, thenExp, elseExp);
+        Exp* left = vals.back();
+        vals.pop_back();
+        vals.push_back(top.rule.swap ? arena->make<BinaryExp>(right, left, top.rule.op)
+                                     : arena->make<BinaryExp>(left, right, top.rule.op));
     }
-
-    // si no hay '?', simplemente devolvemos la comparison
-    return condition;
 }
 
-// comparison: additive ( '<' additive | '>' additive )*
-Exp* Parser::parseComparison() {
-    Exp* left = parseAdditive();
-    while (true) {
-        if (match(Token::LE)) {
-            // left < right
-            Exp* right = parseAdditive();
-            left = new BinaryExp(left, right, LE_OP);
-        } else if (match(Token::GT)) {
-            // left > right  ≈  right < left
-            Exp* right = parseAdditive();
-            left = new BinaryExp(right, left, LE_OP);
-        } else {
-            break;
-        }
-    }
-    return left;
-}
-
-Exp* Parser::parseAdditive() {
-    Exp* left = parseTerm();
-    while (true) {
-        if (match(Token::PLUS)) {
-            Exp* right = parseTerm();
-            left = new BinaryExp(left, right, PLUS_OP);
-        } else if (match(Token::MINUS)) {
-            Exp* right = parseTerm();
-            left = new BinaryExp(left, right, MINUS_OP);
-        } else {
-            break;
-        }
-    }
-    return left;
-}
+Exp* Parser::parseExpression() {
+    vector<Exp*> vals;
+    vector<PendingOp> ops;
+    vector<ExprContext> ctxs;
+    ctxs.push_back(ExprContext{ExprContext::TOP, 0, 0, 0, string_view(), nullptr, nullptr});
+    bool expectOperand = true;
 
-Exp* Parser::parseTerm() {
-    Exp* left = parseFactor();
     while (true) {
-        if (match(Token::MUL)) {
-            Exp* right = parseFactor();
-            left = new BinaryExp(left, right, MUL_OP);
-        } else if (match(Token::DIV)) {
-            Exp* right = parseFactor();
-            left = new BinaryExp(left, right, DIV_OP);
-        } else {
-            break;
-        }
-    }
-    return left;
-}
-
-Exp* Parser::parseFactor() {
-    // Soportar unario '-'
-    if (match(Token::MINUS)) {
-        Exp* inner = parseFactor();
-        return new BinaryExp(new NumberExp(0, 0.0, false, false, false), inner, MINUS_OP);
-    }
-
-    return parsePrimary();
-}
-
-Exp* Parser::parsePrimary() {
-    if (match(Token::NUM)) {
-        string lex = previous->text;
-        bool isLong = false;
-        bool isUnsigned = false;
-        bool isFloat = false;
-
-        if (!lex.empty()) {
-            char last = lex.back();
-            if (last == 'L' || last == 'l') {
-                isLong = true;
-                lex.pop_back();
-            } else if (last == 'U' || last == 'u') {
-                isUnsigned = true;
-                lex.pop_back();
-            } else if (last == 'F' || last == 'f') {
-                isFloat = true;
-                lex.pop_back();
+        if (expectOperand) {
+            if (match(Token::MINUS)) {
+                ops.push_back(PendingOp{BinaryRule{MINUS_OP, PREC_UNARY, false}, true});
+                continue;
             }
+            if (match(Token::NUM)) {
+                vals.push_back(parseNumberLiteral());
+                expectOperand = false;
+                continue;
+            }
+            if (match(Token::ID)) {
+                string_view name = previous().text;
+                // Posible llamada a función: id '(' args ')'
+                if (match(Token::LPAREN)) {
+                    if (match(Token::RPAREN)) {
+                        vals.push_back(arena->make<FcallExp>(string(name), vector<Exp*>()));
+                        expectOperand = false;
+                    } else {
+                        ctxs.push_back(ExprContext{ExprContext::ARG, vals.size(), ops.size(), vals.size(), name, nullptr, nullptr});
+                    }
+                    continue;
+                }
+                vals.push_back(arena->make<IdExp>(names->intern(name)));
+                expectOperand = false;
+                continue;
+            }
+            if (match(Token::LPAREN)) {
+                ctxs.push_back(ExprContext{ExprContext::GROUP, vals.size(), ops.size(), 0, string_view(), nullptr, nullptr});
+                continue;
+            }
+            error("Expresión primaria inválida");
         }
 
-        if (lex.find('.') != string::npos) {
-            isFloat = true;
-        }
-
-        if (isFloat) {
-            double fval = stod(lex);
-            long long ival = static_cast<long long>(fval);
-            return new NumberExp(ival, fval, true, false, false);
-        } else {
-            long long ival = stoll(lex);
-            return new NumberExp(ival, static_cast<double>(ival), false, isLong, isUnsigned);
+        // despues de un operando: operador binario del contexto actual
+        const BinaryRule& rule = kBinaryRules[current().type];
+        if (!isAtEnd() && rule.prec > 0) {
+            advance();
+            reduceOps(arena, vals, ops, ctxs.back().opBase, rule.prec); // asociatividad izquierda
+            ops.push_back(PendingOp{rule, false});
+            expectOperand = true;
+            continue;
         }
-    }
 
-    if (match(Token::ID)) {
-        string name = previous->text;
+        // el contexto termina: reducir lo pendiente y cerrarlo
+        reduceOps(arena, vals, ops, ctxs.back().opBase, 0);
+        Exp* result = vals.back();
+        vals.pop_back();
+        bool afterTernary = false;
+
+        while (true) {
+            ExprContext& ctx = ctxs.back();
+            bool fullExpression = ctx.kind == ExprContext::TOP || ctx.kind == ExprContext::GROUP ||
+                                  ctx.kind == ExprContext::ARG;
+            if (fullExpression && !afterTernary && match(Token::QMARK)) {
+                ctxs.push_back(ExprContext{ExprContext::THEN, vals.size(), ops.size(), 0, string_view(), result, nullptr});
+                expectOperand = true;
+                break;
+            }
 
-        // Posible llamada a función: id '(' args ')'
-        if (match(Token::LPAREN)) {
-            vector<Exp*> args;
-            if (!check(Token::RPAREN)) {
-                // parsear 1 o más argumentos
-                args.push_back(parseExpression());
-                while (match(Token::COMA)) {
-                    args.push_back(parseExpression());
+            if (ctx.kind == ExprContext::TOP) {
+                return result;
+            }
+            if (ctx.kind == ExprContext::GROUP) {
+                if (!match(Token::RPAREN)) {
+                    error("Se esperaba ')' después de la expresión");
                 }
+                ctxs.pop_back();
+                vals.push_back(result);
+                expectOperand = false;
+                break;
             }
-            if (!match(Token::RPAREN)) {
-                error("Se esperaba ')' al final de la llamada a función");
+            if (ctx.kind == ExprContext::ARG) {
+                vals.push_back(result);
+                if (match(Token::COMA)) {
+                    ctx.valBase = vals.size();
+                    ctx.opBase = ops.size();
+                    expectOperand = true;
+                    break;
+                }
+                if (!match(Token::RPAREN)) {
+                    error("Se esperaba ')' al final de la llamada a función");
+                }
+                vector<Exp*> args(vals.begin() + ctx.argBase, vals.end());
+                vals.resize(ctx.argBase);
+                string name(ctx.callee);
+                ctxs.pop_back();
+                vals.push_back(arena->make<FcallExp>(name, args));
+                expectOperand = false;
+                break;
             }
-            return new FcallExp(name, args);
+            if (ctx.kind == ExprContext::THEN) {
+                if (!match(Token::COL)) {
+                    error("Se esperaba ':' en la expresión condicional ternaria");
+                }
+                ctx.kind = ExprContext::ELSE;
+                ctx.thenExp = result;
+                expectOperand = true;
+                break;
+            }
+            // ELSE: el ternario completo es el resultado del contexto padre,
+            // que ya no admite mas operadores
+            result = arena->make<TernaryExp>(ctx.cond, ctx.thenExp, result);
+            ctxs.pop_back();
+            afterTernary = true;
         }
-
-        return new IdExp(name);
     }
+}
 
-    if (match(Token::LPAREN)) {
-        Exp* e = parseExpression();
-        if (!match(Token::RPAREN)) {
-            error("Se esperaba ')' después de la expresión");
+// literal numerico ya consumido en previous (sufijos L, U, F y punto decimal)
+Exp* Parser::parseNumberLiteral() {
+    string lex(previous().text);
+    bool isLong = false;
+    bool isUnsigned = false;
+    bool isFloat = false;
+
+    if (!lex.empty()) {
+        char last = lex.back();
+        if (last == 'L' || last == 'l') {
+            isLong = true;
+            lex.pop_back();
+        } else if (last == 'U' || last == 'u') {
+            isUnsigned = true;
+            lex.pop_back();
+        } else if (last == 'F' || last == 'f') {
+            isFloat = true;
+            lex.pop_back();
         }
-        return e;
     }
 
-    error("Expresión primaria inválida");
-    return nullptr;
+    if (lex.find('.') != string::npos) {
+        isFloat = true;
+    }
+
+    // strtod/strtoll en vez de stod/stoll: un literal fuera de rango es un
+    // error de parseo con su posicion, no una excepcion que tire el proceso
+    errno = 0;
+    if (isFloat) {
+        double fval = strtod(lex.c_str(), nullptr);
+        if (errno == ERANGE && isinf(fval)) literalError(lex);
+        long long ival = fabs(fval) < 9.2e18 ? static_cast<long long>(fval) : 0;
+        return arena->make<NumberExp>(ival, fval, true, false, false);
+    } else {
+        long long ival = strtoll(lex.c_str(), nullptr, 10);
+        if (errno == ERANGE) literalError(lex);
+        return arena->make<NumberExp>(ival, static_cast<double>(ival), false, isLong, isUnsigned);
+    }
 }
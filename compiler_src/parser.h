@@ -3,21 +3,47 @@
 // parser descendente recursivo sobre tokens del scanner
 
 #include "scanner.h"
+#include "token_stream.h"
 #include "ast.h"
+#include "diagnostics.h"
 #include <string>
+#include <vector>
 
 class Parser {
 private:
-    Scanner* scanner;
-    Token* current;
-    Token* previous;
+    // tokens por valor en un ring fijo: previous, current y hasta
+    // MAX_LOOKAHEAD-1 tokens adelantados. no hay new/delete por token.
+    static const int RING_SIZE = 4;  // potencia de 2
+    static const int RING_MASK = RING_SIZE - 1;
+    static const int MAX_LOOKAHEAD = RING_SIZE - 1; // un slot queda para previous
+
+    Scanner* scanner;            // fuente incremental, o bien
+    const TokenStream* stream;   // tokens ya generados por tokenizeAll
+    size_t streamPos;
+    Token ring[RING_SIZE];
+    int head;   // slot de current
+    int filled; // tokens validos desde head (incluye current)
+    Arena* arena; // arena del Program en construccion
+    Interner* names; // identificadores del Program en construccion
+
+    const Token& current() const { return ring[head]; }
+    const Token& previous() const { return ring[(head - 1) & RING_MASK]; }
+    const Token& peek(int k); // k = 0 es current
+    Token fetch();             // siguiente token de scanner o stream
+    void init();
+    size_t position() const { return streamPos - filled; } // indice de current en stream
+    void seek(size_t pos);     // reposiciona current en stream (descarta el ring)
+    bool deferBodies;          // parseDeclarations: saltar cuerpos de funcion
+    Diagnostics* diags;        // errores lexicos y de parseo
 
     // Helpers básicos
     bool advance();
     bool match(Token::Type ttype);
     bool check(Token::Type ttype) const;
     bool isAtEnd() const;
-    void error(const string& msg);
+    [[noreturn]] void error(const string& msg);
+    [[noreturn]] void lexError(); // current es un token ERR
+    [[noreturn]] void literalError(const string& lex); // previous es el literal
 
     // Tipos
     bool     isTypeStart() const;
@@ -46,17 +72,30 @@ private:
     Stm*     parseAssignOrExprStatement();
 
     // Expresiones
-    Exp*     parseExpression();
-    Exp*     parseTernary();
-    Exp*     parseComparison();
-    Exp*     parseAdditive();
-    Exp*     parseTerm();
-    Exp*     parseFactor();
-    Exp*     parsePrimary();
+    Exp*     parseExpression();     // precedencia por tabla, pilas explicitas
+    Exp*     parseNumberLiteral();
 
 public:
-    explicit Parser(Scanner* scanner);
+    // los errores se registran en diags y se lanza CompileError
+    Parser(Scanner* scanner, Diagnostics& diags);
+    Parser(const TokenStream* stream, Diagnostics& diags);
     Program* parseProgram();
+
+    // compilacion por funcion: primero todas las declaraciones de nivel
+    // superior con los cuerpos solo delimitados (cuerpo == nullptr), luego
+    // cada cuerpo se parsea en el arena que indique el llamador.
+    // requiere el constructor con TokenStream.
+    Program* parseDeclarations();
+    Body*    parseFunctionBody(FunDec* fd, Arena& into);
+
+    // funciones alcanzables desde root (en orden de declaracion) segun las
+    // llamadas 'id (' que aparecen en los rangos de tokens de cada cuerpo,
+    // sin parsearlos. si root no existe se devuelven todas.
+    vector<FunDec*> reachableFrom(Program* prog, const string& root) const;
+
+    // a donde van los errores desde ahora; el driver usa uno aparte
+    // mientras parsea un lote por adelantado
+    void setDiagnostics(Diagnostics& d) { diags = &d; }
 };
 
 #endif // PARSER_H
\ No newline at end of file
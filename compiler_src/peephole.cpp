@@ -0,0 +1,568 @@
+#include "peephole.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "visitor.h"
+
+using namespace std;
+
+namespace {
+
+// registros como bits: 0-15 enteros en el orden de la codificacion x86,
+// 16-31 los xmm
+typedef uint32_t Regs;
+
+const char* const R64[16] = {"%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+                             "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15"};
+const char* const R32[16] = {"%eax", "%ecx", "%edx", "%ebx", "%esp", "%ebp", "%esi", "%edi",
+                             "%r8d", "%r9d", "%r10d", "%r11d", "%r12d", "%r13d", "%r14d", "%r15d"};
+const char* const R8[16] = {"%al", "%cl", "%dl", "%bl", "%spl", "%bpl", "%sil", "%dil",
+                            "%r8b", "%r9b", "%r10b", "%r11b", "%r12b", "%r13b", "%r14b", "%r15b"};
+const int RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, XMM0 = 16;
+
+Regs bit(int r) { return Regs(1) << r; }
+
+const Regs TODOS = ~Regs(0);
+// el frame nunca se da por muerto
+const Regs FRAME = bit(RSP) | bit(RBP);
+// lo que lee un call: argumentos enteros, %al con la cantidad de xmm y xmm0-7
+const Regs ARGUMENTOS = bit(RDI) | bit(RSI) | bit(RDX) | bit(RCX) | bit(8) | bit(9) | bit(RAX) | (Regs(0xff) << XMM0);
+const Regs CALLER_SAVED = bit(RAX) | bit(RCX) | bit(RDX) | bit(RSI) | bit(RDI) | bit(8) | bit(9) | bit(10) |
+                          bit(11) | (Regs(0xffff) << XMM0);
+// lo que ve quien llamo: el resultado y los callee-saved restaurados
+const Regs AL_SALIR = bit(RAX) | bit(XMM0) | bit(RBX) | bit(12) | bit(13) | bit(14) | bit(15) | FRAME;
+
+// registro del operando en cualquier ancho; -1 si no es un registro
+int registro(const string& op) {
+    if (op.compare(0, 4, "%xmm") == 0) return XMM0 + atoi(op.c_str() + 4);
+    for (int r = 0; r < 16; ++r) {
+        if (op == R64[r] || op == R32[r] || op == R8[r]) return r;
+    }
+    return -1;
+}
+
+string nombre(int r, int bits) {
+    if (r >= XMM0) return "%xmm" + to_string(r - XMM0);
+    return bits == 8 ? R8[r] : bits == 32 ? R32[r] : R64[r];
+}
+
+bool esMemoria(const string& op) { return op.find('(') != string::npos; }
+bool esInmediato(const string& op) { return !op.empty() && op[0] == '$'; }
+
+// registros que lee un operando: el mismo o los de la direccion
+Regs regsDe(const string& op) {
+    int r = registro(op);
+    if (r >= 0) return bit(r);
+    Regs s = 0;
+    size_t abre = op.find('(');
+    if (abre == string::npos) return 0;
+    size_t cierra = op.find(')', abre);
+    string dentro = op.substr(abre + 1, cierra - abre - 1);
+    size_t desde = 0;
+    while (desde <= dentro.size()) {
+        size_t coma = dentro.find(',', desde);
+        if (coma == string::npos) coma = dentro.size();
+        int base = registro(dentro.substr(desde, coma - desde));
+        if (base >= 0) s |= bit(base);
+        desde = coma + 1;
+    }
+    return s;
+}
+
+bool empieza(const string& s, const char* p) { return s.compare(0, strlen(p), p) == 0; }
+
+// movimientos sin otro efecto que escribir el destino
+bool esMov(const string& m) {
+    return m == "movq" || m == "movl" || m == "movb" || m == "movss" || m == "movzbq" || m == "movslq" || m == "movd" ||
+           m == "leaq" || empieza(m, "cvt");
+}
+
+// add/sub/imul de 32 o 64 bits: el destino se lee y se escribe
+bool esAluEntera(const string& m) {
+    return m == "addl" || m == "addq" || m == "subl" || m == "subq" || m == "imull" || m == "imulq";
+}
+
+int anchoSufijo(const string& m) { return m.back() == 'l' ? 32 : 64; }
+
+string instr(const string& m, const string& a, const string& b) { return " " + m + " " + a + ", " + b; }
+
+struct Instr {
+    enum Tipo { INSTRUCCION, ETIQUETA, SALTO, OTRA } tipo = OTRA;
+    string mnem;
+    vector<string> ops; // SALTO: ops[0] es el texto de la etiqueta destino
+    string clave;       // ETIQUETA y SALTO: identifica la etiqueta dentro de la funcion
+    Regs usa = 0, define = 0;
+};
+
+Instr analizar(const CodeLine& cl) {
+    Instr in;
+    if (cl.kind == CodeLine::SNAP) return in;
+    string s = cl.text;
+    size_t p = s.find_first_not_of(' ');
+    if (p == string::npos) return in;
+    s = s.substr(p);
+    if (cl.kind == CodeLine::LABEL) {
+        // las etiquetas de bloque se numeran al enlazar: prefijo y numero local
+        if (cl.suffix == ":") {
+            in.tipo = Instr::ETIQUETA;
+            in.clave = s + "#" + to_string(cl.num);
+            return in;
+        }
+        size_t sp = s.find(' ');
+        in.tipo = Instr::SALTO;
+        in.mnem = s.substr(0, sp);
+        in.ops.push_back(s.substr(sp + 1));
+        in.clave = in.ops[0] + "#" + to_string(cl.num);
+        return in;
+    }
+    if (s.back() == ':') {
+        in.tipo = Instr::ETIQUETA;
+        in.clave = s.substr(0, s.size() - 1);
+        return in;
+    }
+    if (s[0] == '.') return in; // directiva
+    size_t sp = s.find(' ');
+    in.mnem = s.substr(0, sp);
+    if (sp != string::npos) {
+        size_t desde = sp + 1;
+        while (desde <= s.size()) {
+            size_t coma = s.find(',', desde);
+            if (coma == string::npos) coma = s.size();
+            string op = s.substr(desde, coma - desde);
+            size_t a = op.find_first_not_of(' '), b = op.find_last_not_of(' ');
+            in.ops.push_back(a == string::npos ? "" : op.substr(a, b - a + 1));
+            desde = coma + 1;
+        }
+    }
+    const string& m = in.mnem;
+    if (m[0] == 'j') {
+        // .end_f y cualquier otra etiqueta de texto
+        in.tipo = Instr::SALTO;
+        in.clave = in.ops.empty() ? "" : in.ops[0];
+        return in;
+    }
+    in.tipo = Instr::INSTRUCCION;
+    auto leer = [&](const string& op) { in.usa |= regsDe(op); };
+    auto escribir = [&](const string& op) {
+        int r = registro(op);
+        if (r >= 0) in.define |= bit(r);
+        else leer(op); // memoria: solo lee la direccion
+    };
+    size_t n = in.ops.size();
+    if (m == "call") {
+        in.usa |= ARGUMENTOS;
+        in.define |= CALLER_SAVED;
+    } else if (m == "ret") {
+        in.usa |= AL_SALIR;
+    } else if (m == "leave" || m == "pushq") {
+        if (n == 1) leer(in.ops[0]);
+        in.usa |= FRAME;
+        in.define |= m == "leave" ? FRAME : bit(RSP);
+    } else if (m == "cltd" || m == "cqto") {
+        in.usa |= bit(RAX);
+        in.define |= bit(RDX);
+    } else if (empieza(m, "idiv") && n == 1) {
+        leer(in.ops[0]);
+        in.usa |= bit(RAX) | bit(RDX);
+        in.define |= bit(RAX) | bit(RDX);
+    } else if (empieza(m, "set") && n == 1) {
+        // escribe solo el byte bajo, pero el backend siempre sigue con
+        // movzbq: nadie lee lo que queda arriba
+        escribir(in.ops[0]);
+    } else if ((empieza(m, "cmp") || empieza(m, "ucomis")) && n == 2) {
+        leer(in.ops[0]);
+        leer(in.ops[1]);
+    } else if (esMov(m) && n == 2) {
+        leer(in.ops[0]);
+        escribir(in.ops[1]);
+        // movss entre registros y cvtsi2ss mezclan con lo que habia en el xmm
+        int d = registro(in.ops[1]);
+        bool cargaCompleta = m == "movd" || (m == "movss" && esMemoria(in.ops[0]));
+        if (d >= XMM0 && !cargaCompleta) in.usa |= bit(d);
+    } else if (n == 2) {
+        leer(in.ops[0]);
+        leer(in.ops[1]);
+        escribir(in.ops[1]);
+    } else {
+        in.usa = TODOS; // desconocida: no tocar nada de lo que pueda leer
+    }
+    return in;
+}
+
+// una pasada: analiza las lineas, calcula que registros estan vivos despues
+// de cada una y prueba la tabla de reglas en cada posicion. una regla que
+// aplica consume su ventana y la busqueda sigue despues de ella; las reglas
+// solo quitan lecturas o escrituras de registros muertos, asi la vida
+// calculada al principio de la pasada sigue valiendo (a lo sumo de mas)
+// fuera de las ventanas ya reescritas
+class Mirilla {
+private:
+    vector<CodeLine>& lines;
+    vector<Instr> ins;
+    vector<Regs> vivo; // vivos despues de cada linea
+    vector<bool> borrada;
+
+    void calcularVida();
+
+    // siguiente instruccion o etiqueta despues de i (los snapshots son
+    // comentarios y no cortan la ventana); -1 al final
+    int sig(int i) const {
+        for (int j = i + 1; j < (int)ins.size(); ++j) {
+            if (ins[j].tipo != Instr::OTRA) return j;
+        }
+        return -1;
+    }
+    bool es(int i, Instr::Tipo t) const { return i >= 0 && ins[i].tipo == t; }
+    bool muerto(int r, int i) const { return !(FRAME & bit(r)) && !(vivo[i] & bit(r)); }
+    void borrar(int i) { borrada[i] = true; }
+    void reemplazar(int i, const string& texto) { lines[i].text = texto; }
+
+    // cada regla mira la ventana que empieza en i; si la reescribe devuelve
+    // la ultima linea que uso, si no -1
+    int movPropio(int i);
+    int escrituraMuerta(int i);
+    int copia(int i);
+    int inmediato(int i);
+    int acumulador(int i);
+    int cmpDirecto(int i);
+    int recarga(int i);
+    int saltoFusionado(int i);
+    int saltoSiguiente(int i);
+    // la tabla: las reglas se prueban en el orden de ReglaPeephole
+    int aplicar(ReglaPeephole r, int i);
+
+public:
+    explicit Mirilla(vector<CodeLine>& lines) : lines(lines) {}
+    bool pasada(EstadisticasPeephole& st);
+};
+
+void Mirilla::calcularVida() {
+    size_t n = ins.size();
+    unordered_map<string, int> etiquetas;
+    for (size_t i = 0; i < n; ++i) {
+        if (ins[i].tipo == Instr::ETIQUETA) etiquetas[ins[i].clave] = (int)i;
+    }
+    // sucesores: la linea siguiente salvo jmp y ret, mas el destino del salto
+    vector<int> destino(n, -1);
+    vector<bool> sigue(n, true);
+    for (size_t i = 0; i < n; ++i) {
+        const Instr& in = ins[i];
+        if (in.tipo == Instr::SALTO) {
+            auto it = etiquetas.find(in.clave);
+            destino[i] = it == etiquetas.end() ? -2 : it->second;
+            sigue[i] = in.mnem != "jmp";
+        } else if (in.mnem == "ret") {
+            sigue[i] = false;
+        }
+    }
+    vector<Regs> entrada(n, 0);
+    vivo.assign(n, 0);
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (size_t i = n; i-- > 0;) {
+            Regs salida = 0;
+            if (sigue[i] && i + 1 < n) salida |= entrada[i + 1];
+            if (destino[i] >= 0) salida |= entrada[destino[i]];
+            if (destino[i] == -2) salida = TODOS; // fuera de la funcion
+            Regs e = ins[i].usa | (salida & ~ins[i].define);
+            vivo[i] = salida;
+            if (e != entrada[i]) {
+                entrada[i] = e;
+                cambio = true;
+            }
+        }
+    }
+}
+
+// movq %r, %r (movl no: extiende con ceros)
+int Mirilla::movPropio(int i) {
+    const Instr& a = ins[i];
+    if (a.mnem != "movq" && a.mnem != "movss") return -1;
+    if (a.ops.size() != 2 || a.ops[0] != a.ops[1] || registro(a.ops[0]) < 0) return -1;
+    borrar(i);
+    return i;
+}
+
+// mov a un registro que no se lee antes de volver a escribirse
+int Mirilla::escrituraMuerta(int i) {
+    const Instr& a = ins[i];
+    if (!esMov(a.mnem) || a.mnem == "movb" || a.ops.size() != 2) return -1;
+    int d = registro(a.ops[1]);
+    if (d < 0 || !muerto(d, i)) return -1;
+    borrar(i);
+    return i;
+}
+
+// movq X, %t; movq %t, Y con %t muerto despues -> movq X, Y (tambien
+// movq %r, %t; movslq %t32, Y -> movslq %r32, Y)
+int Mirilla::copia(int i) {
+    const Instr& a = ins[i];
+    int j = sig(i);
+    if (!es(i, Instr::INSTRUCCION) || !es(j, Instr::INSTRUCCION)) return -1;
+    const Instr& b = ins[j];
+    if (a.ops.size() != 2 || b.ops.size() != 2) return -1;
+    int t = registro(a.ops[1]);
+    if (t < 0 || registro(b.ops[0]) != t || !muerto(t, j)) return -1;
+    const string& x = a.ops[0];
+    const string& y = b.ops[1];
+    int ry = registro(y);
+    if (ry == t) return -1;
+    string nueva;
+    if (t >= XMM0) {
+        if (a.mnem != "movss" || b.mnem != "movss" || (esMemoria(x) && esMemoria(y))) return -1;
+        nueva = instr("movss", x, y);
+    } else if (b.mnem == "movslq" && a.mnem == "movq" && registro(x) >= 0 && registro(x) < XMM0) {
+        nueva = instr("movslq", nombre(registro(x), 32), y); // extiende desde el registro original
+    } else if (b.mnem != "movq" || ry >= XMM0) {
+        return -1;
+    } else if (ry >= 0) {
+        if (a.mnem == "movq") nueva = instr("movq", x, y);
+        else if (a.mnem == "movl") nueva = instr("movl", x, nombre(ry, 32));
+        else if (a.mnem == "movzbq" || a.mnem == "movslq") nueva = instr(a.mnem, x, y);
+        else return -1;
+    } else {
+        // a memoria: solo registro o inmediato de 32 bits con signo (movl
+        // extiende con ceros, sirve si el valor no tiene el bit 31)
+        if (esMemoria(x)) return -1;
+        if (esInmediato(x)) {
+            long long c = atoll(x.c_str() + 1);
+            bool cabe = a.mnem == "movq" ? c >= INT32_MIN && c <= INT32_MAX : c >= 0 && c <= INT32_MAX;
+            if (!cabe || (a.mnem != "movq" && a.mnem != "movl")) return -1;
+        } else if (a.mnem != "movq") {
+            return -1;
+        }
+        nueva = instr("movq", x, y);
+    }
+    borrar(i);
+    reemplazar(j, nueva);
+    return j;
+}
+
+// movl $c, %t; [instruccion que no toca %t]; addl %t, D -> addl $c, D
+int Mirilla::inmediato(int i) {
+    const Instr& a = ins[i];
+    if (!es(i, Instr::INSTRUCCION) || (a.mnem != "movl" && a.mnem != "movq")) return -1;
+    if (a.ops.size() != 2 || !esInmediato(a.ops[0])) return -1;
+    int t = registro(a.ops[1]);
+    if (t < 0 || t >= XMM0) return -1;
+    int k = sig(i);
+    if (!es(k, Instr::INSTRUCCION)) return -1;
+    if (!((ins[k].usa | ins[k].define) & bit(t))) {
+        k = sig(k);
+        if (!es(k, Instr::INSTRUCCION)) return -1;
+    }
+    const Instr& c = ins[k];
+    if ((!esAluEntera(c.mnem) && c.mnem != "cmpl" && c.mnem != "cmpq") || c.ops.size() != 2) return -1;
+    if (registro(c.ops[0]) != t || (regsDe(c.ops[1]) & bit(t)) || !muerto(t, k)) return -1;
+    // imul con inmediato necesita el destino en un registro
+    if (empieza(c.mnem, "imul") && registro(c.ops[1]) < 0) return -1;
+    long long v = atoll(a.ops[0].c_str() + 1);
+    // el inmediato de 64 bits se extiende con signo; el de movl con ceros
+    bool cabe = anchoSufijo(c.mnem) == 32 ? v >= INT32_MIN && v <= UINT32_MAX
+                : a.mnem == "movq"        ? v >= INT32_MIN && v <= INT32_MAX
+                                          : v >= 0 && v <= INT32_MAX;
+    if (!cabe) return -1;
+    borrar(i);
+    reemplazar(k, instr(c.mnem, a.ops[0], c.ops[1]));
+    return k;
+}
+
+// movq S, %rax; addl A, %eax; movq %rax, %r -> movq S, %r; addl A, %r32
+// (con %rax muerto despues y A sin leer %r); igual con movss/addss y %xmm0
+int Mirilla::acumulador(int i) {
+    int j = sig(i);
+    int k = j >= 0 ? sig(j) : -1;
+    if (!es(i, Instr::INSTRUCCION) || !es(j, Instr::INSTRUCCION) || !es(k, Instr::INSTRUCCION)) return -1;
+    const Instr& a = ins[i];
+    const Instr& b = ins[j];
+    const Instr& c = ins[k];
+    if (a.ops.size() != 2 || b.ops.size() != 2 || c.ops.size() != 2) return -1;
+    bool flotante = a.mnem == "movss";
+    int acc = flotante ? XMM0 : RAX;
+    if (a.mnem != (flotante ? "movss" : "movq") || c.mnem != a.mnem) return -1;
+    if (flotante ? !(b.mnem == "addss" || b.mnem == "subss" || b.mnem == "mulss" || b.mnem == "divss")
+                 : !esAluEntera(b.mnem))
+        return -1;
+    if (registro(a.ops[1]) != acc || registro(b.ops[1]) != acc || registro(c.ops[0]) != acc) return -1;
+    int y = registro(c.ops[1]);
+    if (y < 0 || y == acc || (y >= XMM0) != flotante || !muerto(acc, k)) return -1;
+    Regs lee = regsDe(b.ops[0]);
+    if (lee & (bit(acc) | bit(y))) return -1;
+    reemplazar(i, instr(a.mnem, a.ops[0], nombre(y, 64)));
+    reemplazar(j, instr(b.mnem, b.ops[0], flotante ? nombre(y, 128) : nombre(y, anchoSufijo(b.mnem))));
+    borrar(k);
+    return k;
+}
+
+// movq S, %rax; cmpl A, %eax -> cmpl A, S (con %rax muerto despues)
+int Mirilla::cmpDirecto(int i) {
+    int j = sig(i);
+    if (!es(i, Instr::INSTRUCCION) || !es(j, Instr::INSTRUCCION)) return -1;
+    const Instr& a = ins[i];
+    const Instr& b = ins[j];
+    if (a.ops.size() != 2 || b.ops.size() != 2) return -1;
+    const string& s = a.ops[0];
+    if (esInmediato(s)) return -1;
+    string nueva;
+    if (a.mnem == "movq" && (b.mnem == "cmpl" || b.mnem == "cmpq")) {
+        if (registro(a.ops[1]) != RAX || registro(b.ops[1]) != RAX || !muerto(RAX, j)) return -1;
+        int rs = registro(s);
+        if (rs >= XMM0 || (regsDe(b.ops[0]) & bit(RAX)) || (esMemoria(s) && esMemoria(b.ops[0]))) return -1;
+        nueva = instr(b.mnem, b.ops[0], rs >= 0 ? nombre(rs, anchoSufijo(b.mnem)) : s);
+    } else if (a.mnem == "movss" && b.mnem == "ucomiss") {
+        // ucomiss necesita el destino en un xmm
+        if (registro(a.ops[1]) != XMM0 || registro(b.ops[1]) != XMM0 || !muerto(XMM0, j)) return -1;
+        if (registro(s) < XMM0 || (regsDe(b.ops[0]) & bit(XMM0))) return -1;
+        nueva = instr(b.mnem, b.ops[0], s);
+    } else {
+        return -1;
+    }
+    borrar(i);
+    reemplazar(j, nueva);
+    return j;
+}
+
+// movl %r, M; movl M, %s -> movl %r, M; movl %r, %s (o nada si s es r)
+int Mirilla::recarga(int i) {
+    int j = sig(i);
+    if (!es(i, Instr::INSTRUCCION) || !es(j, Instr::INSTRUCCION)) return -1;
+    const Instr& a = ins[i];
+    const Instr& b = ins[j];
+    if (a.ops.size() != 2 || b.ops.size() != 2) return -1;
+    const string& m = a.ops[1];
+    if (!esMemoria(m) || b.ops[0] != m || registro(a.ops[0]) < 0 || registro(b.ops[1]) < 0) return -1;
+    string nueva;
+    if (a.mnem == b.mnem && (a.mnem == "movq" || a.mnem == "movl" || a.mnem == "movss")) {
+        if (a.ops[0] == b.ops[1]) {
+            borrar(j);
+            return j;
+        }
+        nueva = instr(a.mnem, a.ops[0], b.ops[1]);
+    } else if (a.mnem == "movb" && b.mnem == "movzbq") {
+        nueva = instr("movzbq", a.ops[0], b.ops[1]);
+    } else {
+        return -1;
+    }
+    reemplazar(j, nueva);
+    return j;
+}
+
+// setl %al; movzbq %al, %r; cmpq $0, %r; je L -> jge L
+int Mirilla::saltoFusionado(int i) {
+    static const char* const INVERSA[][2] = {{"l", "ge"}, {"ge", "l"}, {"le", "g"}, {"g", "le"}, {"b", "ae"},
+                                             {"ae", "b"}, {"be", "a"}, {"a", "be"}, {"e", "ne"}, {"ne", "e"}};
+    int j = sig(i);
+    int k = j >= 0 ? sig(j) : -1;
+    int l = k >= 0 ? sig(k) : -1;
+    if (!es(i, Instr::INSTRUCCION) || !es(j, Instr::INSTRUCCION) || !es(k, Instr::INSTRUCCION) ||
+        !es(l, Instr::SALTO))
+        return -1;
+    const Instr& a = ins[i];
+    const Instr& b = ins[j];
+    const Instr& c = ins[k];
+    const Instr& d = ins[l];
+    if (!empieza(a.mnem, "set") || a.ops.size() != 1 || b.mnem != "movzbq" || b.ops.size() != 2) return -1;
+    if (b.ops[0] != a.ops[0] || c.mnem != "cmpq" || c.ops.size() != 2 || c.ops[0] != "$0") return -1;
+    int r = registro(b.ops[1]);
+    if (r < 0 || registro(c.ops[1]) != r || registro(a.ops[0]) != RAX) return -1;
+    if (d.mnem != "je" && d.mnem != "jne") return -1;
+    if (!muerto(r, l) || !muerto(RAX, l)) return -1;
+    string cc = a.mnem.substr(3), salto;
+    for (auto& par : INVERSA) {
+        if (cc == par[0]) salto = d.mnem == "jne" ? cc : par[1];
+    }
+    if (salto.empty()) return -1;
+    borrar(i);
+    borrar(j);
+    borrar(k);
+    reemplazar(l, " j" + salto + " " + d.ops[0]);
+    return l;
+}
+
+// jmp L justo antes de L: (tambien un condicional: no hace nada)
+int Mirilla::saltoSiguiente(int i) {
+    int j = sig(i);
+    if (!es(i, Instr::SALTO) || !es(j, Instr::ETIQUETA) || ins[i].clave != ins[j].clave) return -1;
+    borrar(i);
+    return i;
+}
+
+int Mirilla::aplicar(ReglaPeephole r, int i) {
+    switch (r) {
+        case P_MOV_PROPIO: return movPropio(i);
+        case P_ESCRITURA_MUERTA: return escrituraMuerta(i);
+        case P_COPIA: return copia(i);
+        case P_INMEDIATO: return inmediato(i);
+        case P_ACUMULADOR: return acumulador(i);
+        case P_CMP_DIRECTO: return cmpDirecto(i);
+        case P_RECARGA: return recarga(i);
+        case P_SALTO_FUSIONADO: return saltoFusionado(i);
+        case P_SALTO_SIGUIENTE: return saltoSiguiente(i);
+        case P_CANTIDAD: break;
+    }
+    return -1;
+}
+
+bool Mirilla::pasada(EstadisticasPeephole& st) {
+    ins.clear();
+    for (const CodeLine& cl : lines) ins.push_back(analizar(cl));
+    calcularVida();
+    borrada.assign(lines.size(), false);
+    bool cambio = false;
+    for (int i = 0; i < (int)lines.size(); ++i) {
+        for (int r = 0; r < P_CANTIDAD; ++r) {
+            int fin = aplicar(ReglaPeephole(r), i);
+            if (fin < 0) continue;
+            st.reescrituras[r]++;
+            cambio = true;
+            i = fin;
+            break;
+        }
+    }
+    if (!cambio) return false;
+    size_t k = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (borrada[i]) continue;
+        if (k != i) lines[k] = std::move(lines[i]);
+        ++k;
+    }
+    lines.resize(k);
+    return true;
+}
+
+} // namespace
+
+const char* nombreReglaPeephole(ReglaPeephole r) {
+    static const char* const NOMBRES[P_CANTIDAD] = {
+        "mov propio", "escritura muerta", "copia", "inmediato", "acumulador",
+        "cmp directo", "recarga", "salto fusionado", "salto siguiente",
+    };
+    return NOMBRES[r];
+}
+
+void EstadisticasPeephole::sumar(const EstadisticasPeephole& otra) {
+    for (int r = 0; r < P_CANTIDAD; ++r) reescrituras[r] += otra.reescrituras[r];
+    pasadas = max(pasadas, otra.pasadas);
+}
+
+int EstadisticasPeephole::total() const {
+    int n = 0;
+    for (int r = 0; r < P_CANTIDAD; ++r) n += reescrituras[r];
+    return n;
+}
+
+EstadisticasPeephole optimizarPeephole(FunctionCode& code) {
+    EstadisticasPeephole st;
+    Mirilla m(code.lines);
+    // cada pasada que cambia algo borra al menos una linea o cambia una
+    // carga por una copia entre registros, asi que termina
+    do {
+        st.pasadas++;
+    } while (m.pasada(st));
+    return st;
+}
@@ -0,0 +1,39 @@
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+// optimizacion de mirilla sobre el asm ya emitido de una funcion (el
+// FunctionCode de emitirX86, antes de enlazarlo). una tabla de patrones
+// chicos (2 a 4 instrucciones) se recorre en pasadas hasta que ninguno
+// aplica; cada reescritura deja en su lugar la instruccion que conserva el
+// efecto, con su linea fuente, asi asmByLine sigue apuntando bien.
+
+using namespace std;
+
+struct FunctionCode;
+
+enum ReglaPeephole {
+    P_MOV_PROPIO,       // movq %r, %r
+    P_ESCRITURA_MUERTA, // mov a un registro que nadie lee despues
+    P_COPIA,            // movq X, %t; movq %t, Y -> movq X, Y
+    P_INMEDIATO,        // movl $c, %t; addl %t, %eax -> addl $c, %eax
+    P_ACUMULADOR,       // movq S, %rax; addl A, %eax; movq %rax, %r -> en %r
+    P_CMP_DIRECTO,      // movq S, %rax; cmpl A, %eax -> cmpl A, S
+    P_RECARGA,          // movl %r, M; movl M, %s -> movl %r, %s
+    P_SALTO_FUSIONADO,  // setl %al; movzbq %al, %r; cmpq $0, %r; je L -> jge L
+    P_SALTO_SIGUIENTE,  // jmp L justo antes de L:
+    P_CANTIDAD
+};
+
+const char* nombreReglaPeephole(ReglaPeephole r);
+
+struct EstadisticasPeephole {
+    int reescrituras[P_CANTIDAD] = {};
+    int pasadas = 0; // la mayor cantidad de pasadas que necesito una funcion
+
+    void sumar(const EstadisticasPeephole& otra);
+    int total() const;
+};
+
+// reescribe code.lines en el lugar y devuelve cuantas veces aplico cada regla
+EstadisticasPeephole optimizarPeephole(FunctionCode& code);
+
+#endif // PEEPHOLE_H
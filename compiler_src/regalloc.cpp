@@ -0,0 +1,208 @@
+#include "regalloc.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+namespace {
+
+const char* const NOMBRES64[] = {"%rbx", "%r12", "%r13", "%r14", "%r15", "%r10", "%r11"};
+const char* const NOMBRES32[] = {"%ebx", "%r12d", "%r13d", "%r14d", "%r15d", "%r10d", "%r11d"};
+const char* const NOMBRES8[] = {"%bl", "%r12b", "%r13b", "%r14b", "%r15b", "%r10b", "%r11b"};
+const char* const NOMBRES_XMM[] = {"%xmm8", "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"};
+
+// orden de preferencia: un intervalo sin llamadas en el medio prueba
+// primero los caller-saved, que no hay que guardar en el prologo
+const Registro ENTEROS_LIBRES[] = {R_R10, R_R11, R_RBX, R_R12, R_R13, R_R14, R_R15};
+const Registro ENTEROS_CALLEE[] = {R_RBX, R_R12, R_R13, R_R14, R_R15};
+const Registro FLOATS[] = {R_XMM8, R_XMM9, R_XMM10, R_XMM11, R_XMM12, R_XMM13, R_XMM14, R_XMM15};
+
+typedef vector<uint64_t> Bits;
+
+bool tiene(const Bits& s, int t) { return (s[t >> 6] >> (t & 63)) & 1; }
+void poner(Bits& s, int t) { s[t >> 6] |= uint64_t(1) << (t & 63); }
+
+struct Intervalo {
+    int temp;
+    int desde = INT_MAX;
+    int hasta = -1;
+    bool cruzaLlamada = false;
+};
+
+} // namespace
+
+const char* nombreRegistro(Registro r, int bits) {
+    if (registroFloat(r)) return NOMBRES_XMM[r - R_XMM8];
+    if (bits == 8) return NOMBRES8[r];
+    if (bits == 32) return NOMBRES32[r];
+    return NOMBRES64[r];
+}
+
+bool registroFloat(Registro r) { return r >= R_XMM8; }
+bool registroCalleeSaved(Registro r) { return r >= R_RBX && r <= R_R15; }
+
+AsignacionRegistros asignarRegistros(const IrFunction& f) {
+    size_t nb = f.blocks.size();
+    size_t nt = f.temps.size();
+    size_t palabras = (nt + 63) / 64;
+
+    // posiciones lineales en el orden del asm: la instruccion k lee sus
+    // operandos en 2k y escribe dst en 2k+1, asi un operando que muere ahi
+    // le puede dejar su registro al resultado
+    vector<int> desde(nb), hasta(nb);
+    vector<int> llamadas;
+    int pos = 0;
+    for (size_t b = 0; b < nb; ++b) {
+        desde[b] = pos;
+        for (const IrInst& in : f.blocks[b].insts) {
+            if (in.op == IR_CALL || in.op == IR_PRINT) llamadas.push_back(pos);
+            pos += 2;
+        }
+        if (f.blocks[b].insts.empty()) pos += 2;
+        hasta[b] = pos - 1;
+    }
+
+    // vida por bloque: live-in = usos antes de definir + (live-out - defs)
+    vector<Bits> usa(nb, Bits(palabras)), define(nb, Bits(palabras));
+    vector<Bits> vivoEntrada(nb, Bits(palabras)), vivoSalida(nb, Bits(palabras));
+    for (size_t b = 0; b < nb; ++b) {
+        for (const IrInst& in : f.blocks[b].insts) {
+            in.forEachUse([&](int t) {
+                if (!tiene(define[b], t)) poner(usa[b], t);
+            });
+            if (in.dst >= 0) poner(define[b], in.dst);
+        }
+    }
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (size_t b = nb; b-- > 0;) {
+            Bits salida(palabras);
+            for (int s : f.blocks[b].succs) {
+                for (size_t w = 0; w < palabras; ++w) salida[w] |= vivoEntrada[s][w];
+            }
+            for (size_t w = 0; w < palabras; ++w) {
+                uint64_t entrada = usa[b][w] | (salida[w] & ~define[b][w]);
+                if (entrada != vivoEntrada[b][w]) {
+                    vivoEntrada[b][w] = entrada;
+                    cambio = true;
+                }
+            }
+            vivoSalida[b] = std::move(salida);
+        }
+    }
+
+    // intervalos sin huecos: del primer punto vivo al ultimo
+    vector<Intervalo> intervalos(nt);
+    auto extender = [&](int t, int p) {
+        intervalos[t].desde = min(intervalos[t].desde, p);
+        intervalos[t].hasta = max(intervalos[t].hasta, p);
+    };
+    for (size_t b = 0; b < nb; ++b) {
+        for (size_t w = 0; w < palabras; ++w) {
+            for (uint64_t m = vivoEntrada[b][w]; m; m &= m - 1) extender(int(w * 64 + __builtin_ctzll(m)), desde[b]);
+            for (uint64_t m = vivoSalida[b][w]; m; m &= m - 1) extender(int(w * 64 + __builtin_ctzll(m)), hasta[b]);
+        }
+        int p = desde[b];
+        for (const IrInst& in : f.blocks[b].insts) {
+            in.forEachUse([&](int t) { extender(t, p); });
+            if (in.dst >= 0) extender(in.dst, p + 1);
+            p += 2;
+        }
+    }
+    vector<Intervalo*> orden;
+    for (size_t t = 0; t < nt; ++t) {
+        Intervalo& iv = intervalos[t];
+        iv.temp = (int)t;
+        if (iv.hasta < 0) continue; // sin uso
+        // vivo a traves de una llamada: definido antes y usado despues
+        auto it = upper_bound(llamadas.begin(), llamadas.end(), iv.desde);
+        iv.cruzaLlamada = it != llamadas.end() && *it < iv.hasta;
+        orden.push_back(&iv);
+    }
+    sort(orden.begin(), orden.end(), [](const Intervalo* a, const Intervalo* b) {
+        return a->desde != b->desde ? a->desde < b->desde : a->temp < b->temp;
+    });
+
+    AsignacionRegistros r;
+    r.reg.assign(nt, R_NINGUNO);
+    r.slot.assign(nt, 0);
+    vector<Intervalo*> activos; // ordenados por hasta
+    bool libre[R_CANTIDAD];
+    fill(begin(libre), end(libre), true);
+    bool usado[R_CANTIDAD] = {};
+    vector<int> derramar;
+
+    for (Intervalo* iv : orden) {
+        // liberar los que terminaron antes de que empiece este
+        size_t k = 0;
+        for (Intervalo* a : activos) {
+            if (a->hasta < iv->desde) libre[r.reg[a->temp]] = true;
+            else activos[k++] = a;
+        }
+        activos.resize(k);
+
+        bool esFloat = irIsFloat(f.temps[iv->temp]);
+        const Registro* candidatos;
+        size_t n;
+        if (esFloat) {
+            // no hay xmm callee-saved: lo que cruza una llamada va al stack
+            candidatos = FLOATS;
+            n = iv->cruzaLlamada ? 0 : sizeof FLOATS / sizeof FLOATS[0];
+        } else if (iv->cruzaLlamada) {
+            candidatos = ENTEROS_CALLEE;
+            n = sizeof ENTEROS_CALLEE / sizeof ENTEROS_CALLEE[0];
+        } else {
+            candidatos = ENTEROS_LIBRES;
+            n = sizeof ENTEROS_LIBRES / sizeof ENTEROS_LIBRES[0];
+        }
+        Registro elegido = R_NINGUNO;
+        for (size_t i = 0; i < n && elegido == R_NINGUNO; ++i) {
+            if (libre[candidatos[i]]) elegido = candidatos[i];
+        }
+        if (elegido == R_NINGUNO && n > 0) {
+            // sin registro libre: se derrama el que termina mas tarde, este
+            // o uno activo con un registro que este pueda usar
+            Intervalo* victima = nullptr;
+            for (Intervalo* a : activos) {
+                Registro ra = r.reg[a->temp];
+                if (find(candidatos, candidatos + n, ra) == candidatos + n) continue;
+                if (!victima || a->hasta > victima->hasta) victima = a;
+            }
+            if (victima && victima->hasta > iv->hasta) {
+                elegido = r.reg[victima->temp];
+                r.reg[victima->temp] = R_NINGUNO;
+                derramar.push_back(victima->temp);
+                activos.erase(find(activos.begin(), activos.end(), victima));
+            }
+        }
+        if (elegido == R_NINGUNO) {
+            derramar.push_back(iv->temp);
+            continue;
+        }
+        r.reg[iv->temp] = elegido;
+        libre[elegido] = false;
+        usado[elegido] = true;
+        activos.insert(upper_bound(activos.begin(), activos.end(), iv,
+                                   [](const Intervalo* a, const Intervalo* b) { return a->hasta < b->hasta; }),
+                       iv);
+    }
+
+    // frame: locales, slots de derrame y lugar para los callee-saved usados
+    int base = f.frameBottom - (((f.frameBottom % 8) + 8) % 8);
+    int proximo = base - 8;
+    sort(derramar.begin(), derramar.end());
+    for (int t : derramar) {
+        r.slot[t] = proximo;
+        proximo -= 8;
+    }
+    for (Registro g : ENTEROS_CALLEE) {
+        if (!usado[g]) continue;
+        r.guardados.push_back({g, proximo});
+        proximo -= 8;
+    }
+    r.frame = proximo < base - 8 ? -(proximo + 8) : -f.frameBottom - 8;
+    if (r.frame < 0) r.frame = 0;
+    if (r.frame % 16 != 0) r.frame += 16 - r.frame % 16;
+    return r;
+}
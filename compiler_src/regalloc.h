@@ -0,0 +1,41 @@
+#ifndef REGALLOC_H
+#define REGALLOC_H
+// asignacion de registros x86-64 por linear scan (poletto y sarkar) sobre el
+// ir ya fuera de ssa. cada temporal ocupa un registro durante todo su
+// intervalo de vida o, si no alcanzan, un slot del frame debajo de las
+// locales. %rax, %rcx, %rdx y %xmm0/%xmm1 quedan para el backend y los
+// registros de argumentos no se asignan, asi que preparar una llamada nunca
+// pisa un temporal.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "ir.h"
+
+using namespace std;
+
+enum Registro : int8_t {
+    R_NINGUNO = -1,
+    // callee-saved: sobreviven a call y a printf
+    R_RBX, R_R12, R_R13, R_R14, R_R15,
+    // caller-saved: solo para intervalos que no cruzan una llamada
+    R_R10, R_R11,
+    R_XMM8, R_XMM9, R_XMM10, R_XMM11, R_XMM12, R_XMM13, R_XMM14, R_XMM15,
+    R_CANTIDAD
+};
+
+// nombre at&t con %; bits 8, 32 o 64 para los enteros (los xmm ignoran bits)
+const char* nombreRegistro(Registro r, int bits = 64);
+bool registroFloat(Registro r);
+bool registroCalleeSaved(Registro r);
+
+struct AsignacionRegistros {
+    vector<Registro> reg;                  // por temporal; R_NINGUNO: en slot (o sin uso)
+    vector<int> slot;                      // offset respecto de %rbp si no tiene registro
+    vector<pair<Registro, int>> guardados; // callee-saved usados y el slot donde se guardan
+    int frame = 0;                         // bytes del subq del prologo (multiplo de 16)
+};
+
+AsignacionRegistros asignarRegistros(const IrFunction& f);
+
+#endif // REGALLOC_H
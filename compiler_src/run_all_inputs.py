@@ -3,11 +3,11 @@ import subprocess
 import shutil
 
 # Archivos c++
-programa = ["main.cpp", "scanner.cpp", "token.cpp", "parser.cpp", "ast.cpp", "visitor.cpp", "semantic_types.h",
+programa = ["main.cpp", "source_buffer.cpp", "scanner.cpp", "token.cpp", "token_stream.cpp", "parser.cpp", "ast.cpp", "arena.cpp", "cache.cpp", "compi.cpp", "daemon.cpp", "diagnostics.cpp", "interner.cpp", "ir.cpp", "peephole.cpp", "regalloc.cpp", "session.cpp", "ssa.cpp", "thread_pool.cpp", "visitor.cpp", "x86_backend.cpp", "semantic_types.h",
 "TypeChecker.cpp"]
 
 # Compilar el proyecto principal
-compile_cmd = ["g++"] + programa
+compile_cmd = ["g++", "-std=c++17", "-pthread"] + programa
 print("Compilando:", " ".join(compile_cmd))
 result = subprocess.run(compile_cmd, capture_output=True, text=True)
 
@@ -22,6 +22,7 @@ input_dir = "inputs"
 output_dir = "outputs"
 os.makedirs(output_dir, exist_ok=True)
 
+entradas = []
 for i in range(1, 8):
     filename = f"input{i}.txt"
     filepath = os.path.join(input_dir, filename)
@@ -29,16 +30,20 @@ for i in range(1, 8):
     if not os.path.isfile(filepath):
         print(filename, "no encontrado en", input_dir)
         continue
-
-    print(f"\n=== Ejecutando {filename} con ./a.out ===")
-    run_cmd = ["./a.out", filepath]
-    result = subprocess.run(run_cmd, capture_output=True, text=True)
-
-    print("stdout:")
-    print(result.stdout)
+    entradas.append(i)
+
+# una sola invocacion compila todas las entradas en paralelo (modo por lotes)
+print(f"\n=== Compilando {len(entradas)} entradas con ./a.out ===")
+run_cmd = ["./a.out"] + [os.path.join(input_dir, f"input{i}.txt") for i in entradas]
+result = subprocess.run(run_cmd, capture_output=True, text=True)
+print(result.stdout)
+if result.stderr:
     print("stderr:")
     print(result.stderr)
-    print("returncode:", result.returncode)
+print("returncode:", result.returncode)
+
+for i in entradas:
+    filename = f"input{i}.txt"
 
     # Nombre y ruta del .s que el programa genera en inputs/
     tokens_file = os.path.join(input_dir, f"input{i}.s")
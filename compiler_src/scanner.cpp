@@ -1,15 +1,20 @@
 #include "scanner.h"
 #include "token.h"
+#include "keywords.h"
 #include <cctype>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 
-Scanner::Scanner(const char* s)
+Scanner::Scanner(string_view s)
     : input(s), first(0), current(0), line(1), col(1) {}
 
 Scanner::~Scanner() {}
 
+Token Scanner::makeToken(Token::Type type, int tokenLine, int tokenCol) const {
+    return Token(type, input, first, current, tokenLine, tokenCol);
+}
+
 void Scanner::advanceChar() {
     if (current < static_cast<int>(input.size()) && input[current] == '\n') {
         line++;
@@ -20,10 +25,10 @@ void Scanner::advanceChar() {
     current++;
 }
 
-Token* Scanner::nextToken() {
+Token Scanner::nextToken() {
     while (true) {
         if (current >= static_cast<int>(input.size())) {
-            return new Token(Token::END, line, col);
+            return Token(Token::END, line, col);
         }
 
         char c = input[current];
@@ -89,7 +94,7 @@ Token* Scanner::nextToken() {
                 input[current] == '"') {
                 advanceChar(); // consumir comilla de cierre
             }
-            return new Token(Token::STRING, input, first, current, tokenLine, tokenCol);
+            return makeToken(Token::STRING, tokenLine, tokenCol);
         }
 
         // numeros (solo enteros por ahora)
@@ -115,7 +120,7 @@ Token* Scanner::nextToken() {
                  input[current] == 'F' || input[current] == 'f')) {
                 advanceChar(); // consumir sufijo de tipo
             }
-            return new Token(Token::NUM, input, first, current, tokenLine, tokenCol);
+            return makeToken(Token::NUM, tokenLine, tokenCol);
         }
 
         // identificadores y palabras clave
@@ -126,59 +131,41 @@ Token* Scanner::nextToken() {
                     input[current] == '_')) {
                 advanceChar();
             }
-            string lex = input.substr(first, current - first);
-
-            if (lex == "return")   return new Token(Token::RETURN,  lex[0], tokenLine, tokenCol);
-            if (lex == "if")       return new Token(Token::IF,      lex[0], tokenLine, tokenCol);
-            if (lex == "else")     return new Token(Token::ELSE,    lex[0], tokenLine, tokenCol);
-            if (lex == "while")    return new Token(Token::WHILE,   lex[0], tokenLine, tokenCol);
-            if (lex == "for")      return new Token(Token::FOR,     lex[0], tokenLine, tokenCol);
-            if (lex == "do")       return new Token(Token::DO,      lex[0], tokenLine, tokenCol);
-            if (lex == "printf")   return new Token(Token::PRINT,   lex[0], tokenLine, tokenCol);
-            if (lex == "true")     return new Token(Token::TRUE,    lex[0], tokenLine, tokenCol);
-            if (lex == "false")    return new Token(Token::FALSE,   lex[0], tokenLine, tokenCol);
-            if (lex == "unsigned") return new Token(Token::UNSIGNED,lex[0], tokenLine, tokenCol);
-            if (lex == "int")      return new Token(Token::INT,     lex[0], tokenLine, tokenCol);
-            if (lex == "float")    return new Token(Token::FLOAT,   lex[0], tokenLine, tokenCol);
-            if (lex == "long")     return new Token(Token::LONG,    lex[0], tokenLine, tokenCol);
-            if (lex == "auto")     return new Token(Token::AUTO,    lex[0], tokenLine, tokenCol);
-
-            // Identificador genérico
-            Token* t = new Token(Token::ID, tokenLine, tokenCol);
-            t->text = lex;
-            return t;
+            // palabra clave o identificador generico: un acceso a la tabla de hash perfecto
+            string_view lex = input.substr(first, current - first);
+            return makeToken(keywords::lookup(lex), tokenLine, tokenCol);
         }
 
         // operadores y signos de puntuacion
         advanceChar();
         switch (c) {
-            case '+': return new Token(Token::PLUS, c, tokenLine, tokenCol);
-            case '-': return new Token(Token::MINUS, c, tokenLine, tokenCol);
+            case '+': return makeToken(Token::PLUS, tokenLine, tokenCol);
+            case '-': return makeToken(Token::MINUS, tokenLine, tokenCol);
             case '*':
                 if (current < static_cast<int>(input.size()) &&
                     input[current] == '*') {
                     advanceChar();
-                    return new Token(Token::POW, '*', tokenLine, tokenCol);
+                    return makeToken(Token::POW, tokenLine, tokenCol);
                 }
-                return new Token(Token::MUL, c, tokenLine, tokenCol);
-            case '/': return new Token(Token::DIV, c, tokenLine, tokenCol);
-            case '%': return new Token(Token::MOD, c, tokenLine, tokenCol);
-            case '(': return new Token(Token::LPAREN, c, tokenLine, tokenCol);
-            case ')': return new Token(Token::RPAREN, c, tokenLine, tokenCol);
-            case '{': return new Token(Token::LBRACE, c, tokenLine, tokenCol);
-            case '}': return new Token(Token::RBRACE, c, tokenLine, tokenCol);
-            case ';': return new Token(Token::SEMICOL, c, tokenLine, tokenCol);
-            case ',': return new Token(Token::COMA, c, tokenLine, tokenCol);
-            case '<': return new Token(Token::LE, c, tokenLine, tokenCol);
-            case '>': return new Token(Token::GT, c, tokenLine, tokenCol);
-            case '=': return new Token(Token::ASSIGN, c, tokenLine, tokenCol);
-            case '?': return new Token(Token::QMARK, c, tokenLine, tokenCol);
-            case ':': return new Token(Token::COL, c, tokenLine, tokenCol);
-            case '\\':return new Token(Token::BACKSLASH, c, tokenLine, tokenCol);
-            case '.': return new Token(Token::DOT, c, tokenLine, tokenCol);
+                return makeToken(Token::MUL, tokenLine, tokenCol);
+            case '/': return makeToken(Token::DIV, tokenLine, tokenCol);
+            case '%': return makeToken(Token::MOD, tokenLine, tokenCol);
+            case '(': return makeToken(Token::LPAREN, tokenLine, tokenCol);
+            case ')': return makeToken(Token::RPAREN, tokenLine, tokenCol);
+            case '{': return makeToken(Token::LBRACE, tokenLine, tokenCol);
+            case '}': return makeToken(Token::RBRACE, tokenLine, tokenCol);
+            case ';': return makeToken(Token::SEMICOL, tokenLine, tokenCol);
+            case ',': return makeToken(Token::COMA, tokenLine, tokenCol);
+            case '<': return makeToken(Token::LE, tokenLine, tokenCol);
+            case '>': return makeToken(Token::GT, tokenLine, tokenCol);
+            case '=': return makeToken(Token::ASSIGN, tokenLine, tokenCol);
+            case '?': return makeToken(Token::QMARK, tokenLine, tokenCol);
+            case ':': return makeToken(Token::COL, tokenLine, tokenCol);
+            case '\\':return makeToken(Token::BACKSLASH, tokenLine, tokenCol);
+            case '.': return makeToken(Token::DOT, tokenLine, tokenCol);
             default:
                 // Carácter no reconocido
-                return new Token(Token::ERR, c, tokenLine, tokenCol);
+                return makeToken(Token::ERR, tokenLine, tokenCol);
         }
     }
 }
@@ -192,14 +179,11 @@ int ejecutar_scanner(Scanner* scanner, const string& inputFile) {
     }
 
     while (true) {
-        Token* tok = scanner->nextToken();
-        if (!tok) break;
-        outFile << *tok << "\n";
-        if (tok->type == Token::END || tok->type == Token::ERR) {
-            delete tok;
+        Token tok = scanner->nextToken();
+        outFile << tok << "\n";
+        if (tok.type == Token::END || tok.type == Token::ERR) {
             break;
         }
-        delete tok;
     }
 
     outFile.close();
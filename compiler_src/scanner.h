@@ -3,20 +3,22 @@
 // scanner lexico basico para c reducido
 
 #include <string>
+#include <string_view>
 #include "token.h"
 using namespace std;
 class Scanner {
 private:
-    string input;
+    string_view input; // buffer del llamador (p.ej. SourceBuffer), no se copia
     int first;
     int current;
     int line;
     int col;
     void advanceChar();
+    Token makeToken(Token::Type type, int tokenLine, int tokenCol) const; // lexema [first, current)
 
 public:
-    Scanner(const char* in_s);
-    Token* nextToken();
+    Scanner(string_view in_s);
+    Token nextToken();
     ~Scanner();
 };
 
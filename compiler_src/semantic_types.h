@@ -6,29 +6,38 @@
 using namespace std;
 
 // ===========================================================
-//  Representación de tipos básicos del lenguaje
+//  Representación de tipos del lenguaje
+//  Cada tipo existe una sola vez y es inmutable: se obtiene con get o
+//  from_string, nunca con new. Comparar tipos es comparar punteros.
+//  Un tipo compuesto (arreglo, función) se agregaría igual, internado
+//  por su estructura para conservar esa igualdad.
 // ===========================================================
 
 class Type {
 public:
     enum TType { NOTYPE, VOID, INT, FLOAT, UINT, LONG, BOOL, AUTO };
 
-    TType ttype;
+    const TType ttype;
 
-    Type() : ttype(NOTYPE) {}
-    Type(TType tt) : ttype(tt) {}
+    Type(const Type&) = delete;
+    Type& operator=(const Type&) = delete;
 
-    // Comparación de tipos
-    bool match(Type* t) const {
-        return this->ttype == t->ttype;
+    // Tipo canónico de un TType básico
+    static const Type* get(TType tt) {
+        static const Type basics[] = {Type(NOTYPE), Type(VOID), Type(INT), Type(FLOAT),
+                                      Type(UINT), Type(LONG), Type(BOOL), Type(AUTO)};
+        return &basics[tt];
     }
 
-    // Asignación de tipo básico desde string
-    bool set_basic_type(const string& s) {
+    // Tipo canónico desde su nombre; nullptr si no es un tipo válido
+    static const Type* from_string(const string& s) {
         TType tt = string_to_type(s);
-        if (tt == NOTYPE) return false;
-        ttype = tt;
-        return true;
+        return tt == NOTYPE ? nullptr : get(tt);
+    }
+
+    // Comparación de tipos
+    bool match(const Type* t) const {
+        return this == t;
     }
 
     // Conversión string 
@@ -57,6 +66,9 @@ public:
             default:    return "notype";
         }
     }
+
+private:
+    explicit Type(TType tt) : ttype(tt) {}
 };
 
 #endif // SEMANTIC_TYPES_H
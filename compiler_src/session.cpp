@@ -0,0 +1,194 @@
+#include "session.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+#include "compi.h"
+#include "hash64.h"
+#include "source_buffer.h"
+
+using namespace std;
+
+static const char* SESSION_MAGIC = "compi-session 2\n";
+
+// =============================
+// Claves
+// =============================
+
+void CompileSession::setProgram(const Program& prog) {
+    decls.clear();
+    names = &prog.names;
+    for (const VarDec* vd : prog.vdlist) {
+        for (Symbol v : vd->vars) decls[names->name(v)] = "g " + vd->type;
+    }
+    for (const FunDec* fd : prog.fdlist) {
+        string sig = "f " + fd->type + "(";
+        for (const string& p : fd->Ptipos) sig += p + ",";
+        decls[fd->nombre] = sig + ")";
+    }
+}
+
+uint64_t CompileSession::keyFor(const TokenStream& ts, const FunDec& fd) const {
+    Hash64 h;
+    h.add(fd.type);
+    h.add(fd.nombre);
+    for (size_t i = 0; i < fd.Ptipos.size(); ++i) {
+        h.add(fd.Ptipos[i]);
+        h.add(names->name(fd.Pnombres[i]));
+    }
+    if (fd.bodyEnd > fd.bodyBegin) {
+        // texto exacto del cuerpo: cambios de lineas internas tambien cuentan
+        size_t from = ts.offset[fd.bodyBegin];
+        size_t to = ts.offset[fd.bodyEnd - 1] + ts.length[fd.bodyEnd - 1];
+        h.add(ts.source.substr(from, to - from));
+    }
+    // dependencias: firma o tipo de cada nombre de nivel superior que aparece
+    unordered_set<string_view> seen;
+    for (size_t i = fd.bodyBegin; i < fd.bodyEnd; ++i) {
+        if (ts.kind[i] != Token::ID) continue;
+        string_view name = ts.source.substr(ts.offset[i], ts.length[i]);
+        if (!seen.insert(name).second) continue;
+        auto it = decls.find(string(name));
+        if (it != decls.end()) {
+            h.add(name);
+            h.add(it->second);
+        }
+    }
+    return h.h;
+}
+
+const CompileSession::Entry* CompileSession::reuse(uint64_t key) {
+    auto it = previous.find(key);
+    if (it == previous.end()) return nullptr;
+    ++reused;
+    return &(current[key] = it->second);
+}
+
+void CompileSession::store(uint64_t key, FunctionCode code, int braceLine) {
+    ++rebuilt;
+    current[key] = Entry{std::move(code), braceLine};
+}
+
+// =============================
+// Persistencia: binario con enteros de 32 bits y strings con largo.
+// el archivo se mapea y se lee con un cursor, sin partir lineas.
+// =============================
+
+namespace {
+
+struct Writer {
+    string buf;
+    void i32(int v) { buf.append(reinterpret_cast<const char*>(&v), sizeof v); }
+    void u64(uint64_t v) { buf.append(reinterpret_cast<const char*>(&v), sizeof v); }
+    void str(const string& s) { i32((int)s.size()); buf += s; }
+};
+
+struct Reader {
+    const char* p;
+    const char* end;
+    void need(size_t n) { if ((size_t)(end - p) < n) throw runtime_error("estado truncado"); }
+    int i32() { int v; need(sizeof v); memcpy(&v, p, sizeof v); p += sizeof v; return v; }
+    uint64_t u64() { uint64_t v; need(sizeof v); memcpy(&v, p, sizeof v); p += sizeof v; return v; }
+    size_t count() { int n = i32(); if (n < 0) throw runtime_error("largo invalido"); return (size_t)n; }
+    string str() { size_t n = count(); need(n); string s(p, n); p += n; return s; }
+};
+
+} // namespace
+
+bool CompileSession::load(const string& path) {
+    previous.clear();
+    SourceBuffer file;
+    if (!file.open(path)) return false;
+    string_view data = file.view();
+    string_view magic(SESSION_MAGIC);
+    if (data.substr(0, magic.size()) != magic) return false;
+
+    Reader in{data.data() + magic.size(), data.data() + data.size()};
+    try {
+        // asm de otro compilador: se descarta y se recompila todo
+        if (in.str() != compilerIdentity()) return false;
+        size_t entries = in.count();
+        for (size_t e = 0; e < entries; ++e) {
+            Entry& entry = previous[in.u64()];
+            entry.braceLine = in.i32();
+            entry.code.labelCount = in.i32();
+            entry.code.endLine = in.i32();
+            entry.code.lines.resize(in.count());
+            for (CodeLine& cl : entry.code.lines) {
+                cl.kind = static_cast<CodeLine::Kind>(in.i32());
+                cl.num = in.i32();
+                cl.line = in.i32();
+                cl.text = in.str();
+                cl.suffix = in.str();
+            }
+            entry.code.snapshots.resize(in.count());
+            for (Snapshot& s : entry.code.snapshots) {
+                s.line = in.i32();
+                s.idx = in.i32();
+                s.label = in.str();
+                s.func = in.str();
+                s.vars.resize(in.count());
+                for (FrameVar& v : s.vars) {
+                    v.offset = in.i32();
+                    v.name = in.str();
+                    v.type = in.str();
+                    v.value = in.str();
+                }
+            }
+        }
+    } catch (const exception&) {
+        // estado corrupto: se descarta completo y se recompila todo
+        previous.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CompileSession::save(const string& path) const {
+    Writer w;
+    w.buf = SESSION_MAGIC;
+    w.str(compilerIdentity());
+    w.i32((int)current.size());
+    for (const auto& kv : current) {
+        const Entry& e = kv.second;
+        w.u64(kv.first);
+        w.i32(e.braceLine);
+        w.i32(e.code.labelCount);
+        w.i32(e.code.endLine);
+        w.i32((int)e.code.lines.size());
+        for (const CodeLine& cl : e.code.lines) {
+            w.i32(cl.kind);
+            w.i32(cl.num);
+            w.i32(cl.line);
+            w.str(cl.text);
+            w.str(cl.suffix);
+        }
+        w.i32((int)e.code.snapshots.size());
+        for (const Snapshot& s : e.code.snapshots) {
+            w.i32(s.line);
+            w.i32(s.idx);
+            w.str(s.label);
+            w.str(s.func);
+            w.i32((int)s.vars.size());
+            for (const FrameVar& v : s.vars) {
+                w.i32(v.offset);
+                w.str(v.name);
+                w.str(v.type);
+                w.str(v.value);
+            }
+        }
+    }
+
+    // se escribe aparte y se renombra: un corte a mitad no deja estado roto
+    string tmp = path + ".tmp";
+    ofstream out(tmp, ios::binary | ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(w.buf.data(), (streamsize)w.buf.size());
+    out.close();
+    if (!out || rename(tmp.c_str(), path.c_str()) != 0) {
+        remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
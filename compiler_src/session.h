@@ -0,0 +1,51 @@
+#ifndef SESSION_H
+#define SESSION_H
+// sesion incremental para el editor: guarda el asm reubicable (FunctionCode)
+// de cada funcion bajo una clave que resume su texto y las firmas/globales
+// que usa. al recompilar, una funcion con la misma clave se enlaza tal cual
+// (desplazando sus lineas) sin parsear, verificar ni generar su cuerpo.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "ast.h"
+#include "token_stream.h"
+#include "visitor.h"
+
+using namespace std;
+
+class CompileSession {
+public:
+    struct Entry {
+        FunctionCode code;
+        int braceLine; // linea del '{' del cuerpo cuando se genero
+    };
+
+private:
+    unordered_map<uint64_t, Entry> previous; // cargado de la sesion anterior
+    unordered_map<uint64_t, Entry> current;  // usado en esta compilacion
+    unordered_map<string, string> decls;     // nombre de nivel superior -> firma o tipo
+    const Interner* names = nullptr;         // del programa de setProgram
+
+public:
+    int reused = 0;
+    int rebuilt = 0;
+
+    // Lee/escribe el estado en disco. Un archivo ausente, de otra version o
+    // escrito por otro binario (compilerIdentity) solo deja la sesion vacia.
+    // save escribe lo usado en esta compilacion.
+    bool load(const string& path);
+    bool save(const string& path) const;
+
+    // Registra firmas y tipos de globales (llamar despues de beginProgram,
+    // cuando los 'auto' globales ya tienen su tipo inferido)
+    void setProgram(const Program& prog);
+    uint64_t keyFor(const TokenStream& ts, const FunDec& fd) const;
+
+    // Entrada previa con esa clave (pasa a la sesion actual) o nullptr
+    const Entry* reuse(uint64_t key);
+    void store(uint64_t key, FunctionCode code, int braceLine);
+};
+
+#endif // SESSION_H
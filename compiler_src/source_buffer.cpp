@@ -0,0 +1,61 @@
+#include "source_buffer.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+
+SourceBuffer::SourceBuffer() : data_(""), size_(0), mapped(false) {}
+
+SourceBuffer::SourceBuffer(string_view external)
+    : data_(external.data()), size_(external.size()), mapped(false) {}
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
+
+void SourceBuffer::release() {
+    if (mapped) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = "";
+    size_ = 0;
+    mapped = false;
+    fallback.clear();
+}
+
+bool SourceBuffer::open(const string& path) {
+    release();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) { // mmap no acepta longitud 0: archivo vacio
+            ::close(fd);
+            return true;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::close(fd);
+            madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL); // el scanner lee de corrido
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<size_t>(st.st_size);
+            mapped = true;
+            return true;
+        }
+    }
+    ::close(fd);
+
+    // no es un archivo regular o fallo mmap: leer completo una sola vez
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return false;
+    ostringstream ss;
+    ss << in.rdbuf();
+    fallback = ss.str();
+    data_ = fallback.data();
+    size_ = fallback.size();
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+// buffer de codigo fuente: mapea el archivo en memoria (mmap) o envuelve
+// un buffer del llamador, sin copiarlo. el scanner trabaja sobre su vista.
+
+#include <string>
+#include <string_view>
+using namespace std;
+
+class SourceBuffer {
+private:
+    const char* data_;
+    size_t size_;
+    bool mapped;      // true si data_ viene de mmap y hay que liberarlo
+    string fallback;  // copia solo si el archivo no se pudo mapear (pipes, etc)
+
+    void release();
+
+public:
+    SourceBuffer();
+    explicit SourceBuffer(string_view external); // buffer del llamador, no se copia
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+
+    // Abre y mapea un archivo. Devuelve false si no se pudo abrir.
+    bool open(const string& path);
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    string_view view() const { return string_view(data_, size_); }
+};
+
+#endif // SOURCE_BUFFER_H
@@ -0,0 +1,737 @@
+#include "ssa.h"
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+bool tienePhi(const IrBlock& b) {
+    return !b.insts.empty() && b.insts.front().op == IR_PHI;
+}
+
+// posicion donde insertar antes del terminador (o al final si no tiene)
+size_t antesDelFinal(const IrBlock& b) {
+    return !b.insts.empty() && b.insts.back().isTerminator() ? b.insts.size() - 1 : b.insts.size();
+}
+
+// bloques alcanzables desde la entrada en postorden (necesita buildCfg)
+vector<int> postOrden(const IrFunction& f) {
+    vector<int> orden;
+    vector<char> visto(f.blocks.size(), 0);
+    vector<pair<int, size_t>> pila{{0, 0}};
+    visto[0] = 1;
+    while (!pila.empty()) {
+        int b = pila.back().first;
+        size_t& i = pila.back().second;
+        const vector<int>& succs = f.blocks[b].succs;
+        if (i < succs.size()) {
+            int s = succs[i++];
+            if (!visto[s]) {
+                visto[s] = 1;
+                pila.push_back({s, 0});
+            }
+            continue;
+        }
+        orden.push_back(b);
+        pila.pop_back();
+    }
+    return orden;
+}
+
+// descarta los bloques no vivos. sus snapshots no ejecutan pero siguen
+// marcando el asm, asi que pasan al bloque vivo anterior
+void quitarBloques(IrFunction& f, const vector<char>& vivo) {
+    vector<int> orden;
+    int ultimo = -1;
+    for (size_t b = 0; b < f.blocks.size(); ++b) {
+        if (vivo[b]) {
+            orden.push_back((int)b);
+            ultimo = (int)b;
+            continue;
+        }
+        for (IrInst& in : f.blocks[b].insts) {
+            if (in.op != IR_SNAP || ultimo < 0) continue;
+            IrBlock& destino = f.blocks[ultimo];
+            destino.insts.insert(destino.insts.begin() + antesDelFinal(destino), std::move(in));
+        }
+    }
+    if (orden.size() == f.blocks.size()) return;
+    f.reorderBlocks(orden);
+    f.buildCfg();
+}
+
+void quitarInalcanzables(IrFunction& f) {
+    vector<char> vivo(f.blocks.size(), 0);
+    for (int b : postOrden(f)) vivo[b] = 1;
+    quitarBloques(f, vivo);
+}
+
+// dominador inmediato de cada bloque (cooper, harvey y kennedy). todos los
+// bloques tienen que ser alcanzables
+vector<int> dominadores(const IrFunction& f) {
+    vector<int> po = postOrden(f);
+    vector<int> numero(f.blocks.size());
+    for (size_t i = 0; i < po.size(); ++i) numero[po[i]] = (int)i;
+    vector<int> idom(f.blocks.size(), -1);
+    idom[0] = 0;
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        for (size_t i = po.size(); i-- > 0;) {
+            int b = po[i];
+            if (b == 0) continue;
+            int nuevo = -1;
+            for (int p : f.blocks[b].preds) {
+                if (idom[p] < 0) continue;
+                if (nuevo < 0) {
+                    nuevo = p;
+                    continue;
+                }
+                int x = p, y = nuevo;
+                while (x != y) {
+                    while (numero[x] < numero[y]) x = idom[x];
+                    while (numero[y] < numero[x]) y = idom[y];
+                }
+                nuevo = x;
+            }
+            if (idom[b] != nuevo) {
+                idom[b] = nuevo;
+                cambio = true;
+            }
+        }
+    }
+    return idom;
+}
+
+// ---------------------------------------------------------------------
+// valores constantes: contenido completo del registro de 64 bits (los
+// enteros de 32 bits extendidos con ceros, los float como sus bits)
+// ---------------------------------------------------------------------
+
+float aFloat(int64_t v) {
+    uint32_t u = (uint32_t)v;
+    float x;
+    memcpy(&x, &u, sizeof x);
+    return x;
+}
+
+int64_t deFloat(float x) {
+    uint32_t u;
+    memcpy(&u, &x, sizeof u);
+    return u;
+}
+
+int64_t alAncho(IrType t, int64_t v) {
+    if (t == IrType::BOOL) return (uint8_t)v;
+    if (irIs32(t) || irIsFloat(t)) return (uint32_t)v;
+    return v;
+}
+
+// false si la operacion no se puede plegar (division por cero, conversion
+// fuera de rango): se deja para que el programa haga lo mismo que antes
+bool plegar(IrOp op, IrType t, IrType desde, int64_t a, int64_t b, int64_t& r) {
+    if (op == IR_CONST) {
+        r = alAncho(t, a);
+        return true;
+    }
+    if (op == IR_COPY) {
+        r = a;
+        return true;
+    }
+    if (op == IR_CVT) {
+        if (irIsFloat(t) && irIsFloat(desde)) {
+            r = a;
+        } else if (irIsFloat(t)) {
+            r = deFloat(desde == IrType::I32 ? (float)(int32_t)a : (float)a);
+        } else if (irIsFloat(desde)) {
+            float x = aFloat(a);
+            if (irIs32(t)) {
+                if (!(x >= -2147483648.0f && x < 2147483648.0f)) return false;
+                r = (uint32_t)(int32_t)x;
+            } else {
+                if (!(x >= -9223372036854775808.0f && x < 9223372036854775808.0f)) return false;
+                r = (int64_t)x;
+            }
+        } else if (desde == IrType::I32 && !irIs32(t) && t != IrType::BOOL) {
+            r = (int32_t)a;
+        } else {
+            r = alAncho(t, a);
+        }
+        return true;
+    }
+    if (irIsFloat(t)) {
+        float x = aFloat(a), y = aFloat(b);
+        switch (op) {
+            case IR_ADD: r = deFloat(x + y); break;
+            case IR_SUB: r = deFloat(x - y); break;
+            case IR_MUL: r = deFloat(x * y); break;
+            case IR_DIV: r = deFloat(x / y); break;
+            case IR_LT:  r = (x < y || isnan(x) || isnan(y)); break; // ucomiss + setb
+            default: return false;
+        }
+        return true;
+    }
+    if (irIs32(t)) {
+        uint32_t x = (uint32_t)a, y = (uint32_t)b;
+        switch (op) {
+            case IR_ADD: r = (uint32_t)(x + y); break;
+            case IR_SUB: r = (uint32_t)(x - y); break;
+            case IR_MUL: r = (uint32_t)(x * y); break;
+            case IR_DIV: // idivl tambien para unsigned
+                if (y == 0 || ((int32_t)x == INT32_MIN && (int32_t)y == -1)) return false;
+                r = (uint32_t)((int32_t)x / (int32_t)y);
+                break;
+            case IR_LT: r = t == IrType::U32 ? x < y : (int32_t)x < (int32_t)y; break;
+            default: return false;
+        }
+        return true;
+    }
+    uint64_t x = (uint64_t)a, y = (uint64_t)b;
+    switch (op) {
+        case IR_ADD: r = (int64_t)(x + y); break;
+        case IR_SUB: r = (int64_t)(x - y); break;
+        case IR_MUL: r = (int64_t)(x * y); break;
+        case IR_DIV:
+            if (y == 0 || (a == INT64_MIN && b == -1)) return false;
+            r = a / b;
+            break;
+        case IR_LT: r = t == IrType::U64 ? x < y : a < b; break;
+        default: return false;
+    }
+    return true;
+}
+
+struct Valor {
+    enum Nivel : uint8_t { ARRIBA, CONSTANTE, ABAJO }; // sin informacion aun / conocido / variable
+    Nivel nivel = ARRIBA;
+    int64_t v = 0;
+};
+
+// propagacion condicional dispersa
+class Sccp {
+private:
+    IrFunction& f;
+    vector<Valor> valor;
+    vector<vector<pair<int, int>>> usos;   // temporal -> (bloque, instruccion)
+    vector<char> bloqueVivo;
+    vector<vector<int>> entradasVivas;     // bloque -> predecesores por aristas ejecutables
+    vector<pair<int, int>> aristas;        // pendientes
+    vector<int> temporales;                // pendientes
+
+    bool aristaViva(int desde, int hacia) const {
+        for (int p : entradasVivas[hacia]) {
+            if (p == desde) return true;
+        }
+        return false;
+    }
+
+    void bajar(int t, Valor v) {
+        Valor& actual = valor[t];
+        if (actual.nivel == v.nivel && (v.nivel != Valor::CONSTANTE || actual.v == v.v)) return;
+        if (actual.nivel == Valor::CONSTANTE && v.nivel == Valor::CONSTANTE) v.nivel = Valor::ABAJO;
+        if (v.nivel < actual.nivel) return; // el reticulado solo baja
+        actual = v;
+        temporales.push_back(t);
+    }
+
+    void arista(int desde, int hacia) {
+        if (!aristaViva(desde, hacia)) aristas.push_back({desde, hacia});
+    }
+
+    void evaluar(int b, const IrInst& in);
+
+public:
+    explicit Sccp(IrFunction& f) : f(f) {}
+    void run();
+};
+
+void Sccp::evaluar(int b, const IrInst& in) {
+    switch (in.op) {
+        case IR_PHI: {
+            Valor r;
+            for (size_t k = 0; k < in.args.size(); ++k) {
+                if (!aristaViva(in.from[k], b)) continue;
+                const Valor& x = valor[in.args[k]];
+                if (x.nivel == Valor::ARRIBA) continue;
+                if (x.nivel == Valor::ABAJO || (r.nivel == Valor::CONSTANTE && r.v != x.v)) {
+                    r.nivel = Valor::ABAJO;
+                    break;
+                }
+                r = x;
+            }
+            bajar(in.dst, r);
+            return;
+        }
+        case IR_JMP:
+            arista(b, in.target);
+            return;
+        case IR_BR: {
+            const Valor& c = valor[in.a];
+            if (c.nivel == Valor::ARRIBA) return;
+            if (c.nivel == Valor::ABAJO || c.v != 0) arista(b, in.target);
+            if (c.nivel == Valor::ABAJO || c.v == 0) arista(b, in.other);
+            return;
+        }
+        case IR_CONST:
+        case IR_COPY:
+        case IR_CVT:
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_LT: {
+            Valor x, y;
+            x.nivel = y.nivel = Valor::CONSTANTE;
+            if (in.op == IR_CONST) x.v = in.imm;
+            if (in.a >= 0) x = valor[in.a];
+            if (in.b >= 0) y = valor[in.b];
+            if (x.nivel == Valor::ABAJO || y.nivel == Valor::ABAJO) {
+                bajar(in.dst, Valor{Valor::ABAJO, 0});
+                return;
+            }
+            if (x.nivel == Valor::ARRIBA || y.nivel == Valor::ARRIBA) return;
+            int64_t r;
+            IrType desde = in.a >= 0 ? f.temps[in.a] : in.type;
+            if (plegar(in.op, in.type, desde, x.v, y.v, r)) bajar(in.dst, Valor{Valor::CONSTANTE, r});
+            else bajar(in.dst, Valor{Valor::ABAJO, 0});
+            return;
+        }
+        default: // LOAD, ARG, CALL: valores que solo se conocen al ejecutar
+            if (in.dst >= 0) bajar(in.dst, Valor{Valor::ABAJO, 0});
+            return;
+    }
+}
+
+void Sccp::run() {
+    size_t nb = f.blocks.size();
+    valor.assign(f.temps.size(), Valor{});
+    usos.assign(f.temps.size(), {});
+    for (size_t b = 0; b < nb; ++b) {
+        vector<IrInst>& insts = f.blocks[b].insts;
+        for (size_t i = 0; i < insts.size(); ++i) {
+            insts[i].forEachUse([&](int& t) { usos[t].push_back({(int)b, (int)i}); });
+        }
+    }
+    bloqueVivo.assign(nb, 0);
+    entradasVivas.assign(nb, {});
+
+    aristas.push_back({-1, 0});
+    while (!aristas.empty() || !temporales.empty()) {
+        while (!aristas.empty()) {
+            pair<int, int> e = aristas.back();
+            aristas.pop_back();
+            int b = e.second;
+            if (e.first >= 0) {
+                if (aristaViva(e.first, b)) continue;
+                entradasVivas[b].push_back(e.first);
+            }
+            const vector<IrInst>& insts = f.blocks[b].insts;
+            if (bloqueVivo[b]) { // ya evaluado: solo cambian sus phi
+                for (size_t i = 0; i < insts.size() && insts[i].op == IR_PHI; ++i) evaluar(b, insts[i]);
+                continue;
+            }
+            bloqueVivo[b] = 1;
+            for (const IrInst& in : insts) evaluar(b, in);
+            if (f.blocks[b].succs.size() == 1 && (insts.empty() || !insts.back().isTerminator())) {
+                arista(b, f.blocks[b].succs[0]); // cae al siguiente
+            }
+        }
+        while (!temporales.empty() && aristas.empty()) {
+            int t = temporales.back();
+            temporales.pop_back();
+            for (const pair<int, int>& u : usos[t]) {
+                if (bloqueVivo[u.first]) evaluar(u.first, f.blocks[u.first].insts[u.second]);
+            }
+        }
+    }
+
+    // reescribir: constantes como CONST, saltos decididos como JMP
+    for (size_t b = 0; b < nb; ++b) {
+        if (!bloqueVivo[b]) continue;
+        vector<IrInst>& insts = f.blocks[b].insts;
+        vector<IrInst> phis, resto;
+        for (IrInst& in : insts) {
+            if (in.dst >= 0 && in.op != IR_CONST && valor[in.dst].nivel == Valor::CONSTANTE &&
+                in.op != IR_CALL) {
+                IrInst c;
+                c.op = IR_CONST;
+                c.type = f.temps[in.dst];
+                c.dst = in.dst;
+                c.line = in.line;
+                int64_t v = valor[in.dst].v;
+                c.imm = irIs32(c.type) ? (int64_t)(int32_t)v : v;
+                in = std::move(c);
+            } else if (in.op == IR_BR && valor[in.a].nivel == Valor::CONSTANTE) {
+                in.op = IR_JMP;
+                in.target = valor[in.a].v != 0 ? in.target : in.other;
+                in.other = -1;
+                in.a = -1;
+            }
+            (in.op == IR_PHI ? phis : resto).push_back(std::move(in));
+        }
+        phis.insert(phis.end(), make_move_iterator(resto.begin()), make_move_iterator(resto.end()));
+        insts = std::move(phis);
+    }
+    quitarBloques(f, bloqueVivo);
+    f.buildCfg();
+
+    // las entradas de phi por aristas que ya no existen
+    for (IrBlock& blk : f.blocks) {
+        for (IrInst& in : blk.insts) {
+            if (in.op != IR_PHI) break;
+            size_t k = 0;
+            for (size_t i = 0; i < in.from.size(); ++i) {
+                bool sigue = false;
+                for (int p : blk.preds) sigue = sigue || p == in.from[i];
+                if (!sigue) continue;
+                in.from[k] = in.from[i];
+                in.args[k] = in.args[i];
+                ++k;
+            }
+            in.from.resize(k);
+            in.args.resize(k);
+        }
+    }
+}
+
+} // namespace
+
+void construirSsa(IrFunction& f) {
+    f.buildCfg();
+    quitarInalcanzables(f);
+    size_t nb = f.blocks.size();
+    vector<int> idom = dominadores(f);
+    vector<vector<int>> hijos(nb), frontera(nb);
+    for (size_t b = 1; b < nb; ++b) hijos[idom[b]].push_back((int)b);
+    for (size_t b = 0; b < nb; ++b) {
+        const vector<int>& preds = f.blocks[b].preds;
+        if (preds.size() < 2) continue;
+        for (int p : preds) {
+            for (int x = p; x != idom[b]; x = idom[x]) {
+                if (frontera[x].empty() || frontera[x].back() != (int)b) frontera[x].push_back((int)b);
+            }
+        }
+    }
+
+    // variables a renombrar: locales por offset y temporales definidos mas
+    // de una vez (el resultado de un ternario se copia en cada rama)
+    struct Variable {
+        IrType type;
+        IrVar mem;          // locales
+        bool local;
+        vector<int> bloquesDef;
+    };
+    vector<Variable> vars;
+    unordered_map<int, int> porOffset;
+    size_t nt = f.temps.size();
+    vector<int> defs(nt, 0), porTemp(nt, -1);
+    for (IrBlock& blk : f.blocks) {
+        for (IrInst& in : blk.insts) {
+            if (in.dst >= 0) defs[in.dst]++;
+        }
+    }
+    for (size_t b = 0; b < nb; ++b) {
+        for (IrInst& in : f.blocks[b].insts) {
+            int v = -1;
+            if ((in.op == IR_LOAD || in.op == IR_STORE) && !in.var.global) {
+                auto it = porOffset.find(in.var.offset);
+                if (it == porOffset.end()) {
+                    it = porOffset.emplace(in.var.offset, (int)vars.size()).first;
+                    vars.push_back(Variable{in.var.type, in.var, true, {}});
+                }
+                if (in.op == IR_STORE) v = it->second;
+            } else if (in.dst >= 0 && defs[in.dst] > 1) {
+                if (porTemp[in.dst] < 0) {
+                    porTemp[in.dst] = (int)vars.size();
+                    vars.push_back(Variable{f.temps[in.dst], IrVar{}, false, {}});
+                }
+                v = porTemp[in.dst];
+            }
+            if (v >= 0 && (vars[v].bloquesDef.empty() || vars[v].bloquesDef.back() != (int)b)) {
+                vars[v].bloquesDef.push_back((int)b);
+            }
+        }
+    }
+    if (vars.empty()) return;
+
+    // phi en la frontera de dominancia iterada de las definiciones; imm
+    // guarda la variable hasta renombrar
+    vector<int> conPhi(nb, -1), enLista(nb, -1);
+    for (size_t v = 0; v < vars.size(); ++v) {
+        vector<int> trabajo = vars[v].bloquesDef;
+        for (int b : trabajo) enLista[b] = (int)v;
+        while (!trabajo.empty()) {
+            int x = trabajo.back();
+            trabajo.pop_back();
+            for (int d : frontera[x]) {
+                if (conPhi[d] == (int)v) continue;
+                conPhi[d] = (int)v;
+                IrInst phi;
+                phi.op = IR_PHI;
+                phi.type = vars[v].type;
+                phi.imm = (int64_t)v;
+                phi.from = f.blocks[d].preds;
+                phi.args.assign(phi.from.size(), -1);
+                phi.line = f.blocks[d].line;
+                f.blocks[d].insts.insert(f.blocks[d].insts.begin(), std::move(phi));
+                if (enLista[d] != (int)v) {
+                    enLista[d] = (int)v;
+                    trabajo.push_back(d);
+                }
+            }
+        }
+    }
+
+    // renombrar recorriendo el arbol de dominadores
+    vector<vector<int>> pila(vars.size());
+    vector<int> indefinido(vars.size(), -1);
+    vector<IrInst> iniciales; // valores de las variables no asignadas aun
+    vector<int> alias(nt, -1); // LOAD de local -> valor que tenia la variable
+    auto actual = [&](int v) {
+        if (!pila[v].empty()) return pila[v].back();
+        if (indefinido[v] < 0) {
+            // la local se lee sin asignar: queda lo que haya en su slot
+            IrInst in;
+            in.op = vars[v].local ? IR_LOAD : IR_CONST;
+            in.type = vars[v].type;
+            in.var = vars[v].mem;
+            in.dst = indefinido[v] = f.newTemp(vars[v].type);
+            in.line = f.prologLine;
+            iniciales.push_back(std::move(in));
+        }
+        return indefinido[v];
+    };
+    auto renombrar = [&](int& t) {
+        if ((size_t)t >= nt) return;
+        if (alias[t] >= 0) t = alias[t];
+        else if (porTemp[t] >= 0) t = actual(porTemp[t]);
+    };
+
+    vector<vector<int>> empujados(nb);
+    vector<pair<int, bool>> recorrido{{0, false}};
+    while (!recorrido.empty()) {
+        int b = recorrido.back().first;
+        bool salida = recorrido.back().second;
+        recorrido.pop_back();
+        if (salida) {
+            for (int v : empujados[b]) pila[v].pop_back();
+            continue;
+        }
+        vector<IrInst> nuevas;
+        nuevas.reserve(f.blocks[b].insts.size());
+        for (IrInst& in : f.blocks[b].insts) {
+            if (in.op == IR_PHI) {
+                int v = (int)in.imm;
+                in.dst = f.newTemp(vars[v].type);
+                pila[v].push_back(in.dst);
+                empujados[b].push_back(v);
+                nuevas.push_back(std::move(in));
+                continue;
+            }
+            in.forEachUse(renombrar);
+            if (in.op == IR_LOAD && !in.var.global) {
+                alias[in.dst] = actual(porOffset[in.var.offset]);
+                continue;
+            }
+            int v = -1, valor = -1;
+            if (in.op == IR_STORE && !in.var.global) {
+                v = porOffset[in.var.offset];
+                valor = in.a;
+                if (f.temps[valor] != vars[v].type) { // lo que el store y el load harian con el valor
+                    IrInst cvt;
+                    cvt.op = IR_CVT;
+                    cvt.type = vars[v].type;
+                    cvt.a = valor;
+                    cvt.dst = valor = f.newTemp(vars[v].type);
+                    cvt.line = in.line;
+                    nuevas.push_back(std::move(cvt));
+                }
+            } else if (in.dst >= 0 && (size_t)in.dst < nt && porTemp[in.dst] >= 0) {
+                v = porTemp[in.dst];
+                in.dst = valor = f.newTemp(vars[v].type);
+                nuevas.push_back(std::move(in));
+            } else {
+                nuevas.push_back(std::move(in));
+            }
+            if (v >= 0) {
+                pila[v].push_back(valor);
+                empujados[b].push_back(v);
+            }
+        }
+        f.blocks[b].insts = std::move(nuevas);
+        for (int s : f.blocks[b].succs) {
+            for (IrInst& phi : f.blocks[s].insts) {
+                if (phi.op != IR_PHI) break;
+                for (size_t k = 0; k < phi.from.size(); ++k) {
+                    if (phi.from[k] == b) phi.args[k] = actual((int)phi.imm);
+                }
+            }
+        }
+        recorrido.push_back({b, true});
+        for (int h : hijos[b]) recorrido.push_back({h, false});
+    }
+
+    for (IrBlock& blk : f.blocks) {
+        for (IrInst& in : blk.insts) {
+            if (in.op == IR_PHI) in.imm = 0;
+        }
+    }
+    // los valores iniciales van despues de leer los registros de parametros
+    vector<IrInst>& entrada = f.blocks[0].insts;
+    size_t pos = 0;
+    while (pos < entrada.size() && entrada[pos].op == IR_ARG) ++pos;
+    entrada.insert(entrada.begin() + pos, make_move_iterator(iniciales.begin()),
+                   make_move_iterator(iniciales.end()));
+}
+
+void propagarConstantes(IrFunction& f) {
+    Sccp(f).run();
+}
+
+void eliminarCodigoMuerto(IrFunction& f) {
+    vector<IrInst*> def(f.temps.size(), nullptr);
+    vector<char> usado(f.temps.size(), 0);
+    vector<int> trabajo;
+    auto usar = [&](int& t) {
+        if (!usado[t]) {
+            usado[t] = 1;
+            trabajo.push_back(t);
+        }
+    };
+    // raices: lo que tiene efecto (la division se queda por si divide por cero)
+    auto conEfecto = [](const IrInst& in) {
+        return in.op == IR_STORE || in.op == IR_CALL || in.op == IR_PRINT || in.op == IR_SNAP ||
+               in.op == IR_DIV || in.isTerminator();
+    };
+    for (IrBlock& blk : f.blocks) {
+        for (IrInst& in : blk.insts) {
+            if (in.dst >= 0) def[in.dst] = &in;
+            if (conEfecto(in)) in.forEachUse(usar);
+        }
+    }
+    while (!trabajo.empty()) {
+        int t = trabajo.back();
+        trabajo.pop_back();
+        if (def[t]) def[t]->forEachUse(usar);
+    }
+    for (IrBlock& blk : f.blocks) {
+        vector<IrInst>& insts = blk.insts;
+        size_t k = 0;
+        for (size_t i = 0; i < insts.size(); ++i) {
+            if (!conEfecto(insts[i]) && (insts[i].dst < 0 || !usado[insts[i].dst])) continue;
+            if (k != i) insts[k] = std::move(insts[i]);
+            ++k;
+        }
+        insts.resize(k);
+    }
+}
+
+void destruirSsa(IrFunction& f) {
+    f.buildCfg();
+    size_t nb = f.blocks.size();
+
+    // partir aristas criticas hacia bloques con phi: las copias de esa
+    // arista van en un bloque nuevo, justo antes del destino
+    vector<vector<int>> antesDe(nb);
+    for (size_t s = 0; s < nb; ++s) {
+        if (!tienePhi(f.blocks[s]) || f.blocks[s].preds.size() < 2) continue;
+        vector<int> preds = f.blocks[s].preds;
+        for (int p : preds) {
+            if (f.blocks[p].succs.size() < 2) continue;
+            int n = (int)f.blocks.size();
+            f.blocks.emplace_back();
+            IrBlock& nuevo = f.blocks.back();
+            nuevo.line = f.blocks[s].line;
+            IrInst jmp;
+            jmp.op = IR_JMP;
+            jmp.target = (int)s;
+            jmp.line = nuevo.line;
+            nuevo.insts.push_back(std::move(jmp));
+            IrInst& t = f.blocks[p].insts.back();
+            if (t.target == (int)s) t.target = n;
+            if (t.other == (int)s) t.other = n;
+            for (IrInst& phi : f.blocks[s].insts) {
+                if (phi.op != IR_PHI) break;
+                for (int& desde : phi.from) {
+                    if (desde == p) desde = n;
+                }
+            }
+            antesDe[s].push_back(n);
+        }
+    }
+    if (f.blocks.size() != nb) {
+        vector<int> orden;
+        for (size_t b = 0; b < nb; ++b) {
+            orden.insert(orden.end(), antesDe[b].begin(), antesDe[b].end());
+            orden.push_back((int)b);
+        }
+        f.reorderBlocks(orden);
+        f.buildCfg();
+    }
+
+    for (IrBlock& blk : f.blocks) {
+        size_t nphi = 0;
+        while (nphi < blk.insts.size() && blk.insts[nphi].op == IR_PHI) ++nphi;
+        if (nphi == 0) continue;
+        if (blk.preds.size() == 1) { // un solo camino: la copia queda en el mismo bloque
+            for (size_t i = 0; i < nphi; ++i) {
+                IrInst& phi = blk.insts[i];
+                phi.op = IR_COPY;
+                phi.a = phi.args[0];
+                phi.args.clear();
+                phi.from.clear();
+            }
+            continue;
+        }
+        for (int p : blk.preds) {
+            vector<pair<int, int>> copias; // (dst, origen)
+            for (size_t i = 0; i < nphi; ++i) {
+                const IrInst& phi = blk.insts[i];
+                for (size_t k = 0; k < phi.from.size(); ++k) {
+                    if (phi.from[k] == p && phi.args[k] != phi.dst) copias.push_back({phi.dst, phi.args[k]});
+                }
+            }
+            // las copias son paralelas: si una lee lo que otra escribe (ej.
+            // un intercambio) pasan primero por temporales nuevos
+            bool pisa = false;
+            for (auto& c : copias) {
+                for (auto& d : copias) pisa = pisa || c.second == d.first;
+            }
+            IrBlock& pred = f.blocks[p];
+            int linea = pred.insts.empty() ? pred.line : pred.insts.back().line;
+            vector<IrInst> nuevas;
+            auto copiar = [&](int dst, int origen) {
+                IrInst in;
+                in.op = IR_COPY;
+                in.type = f.temps[dst];
+                in.dst = dst;
+                in.a = origen;
+                in.line = linea;
+                nuevas.push_back(std::move(in));
+            };
+            if (pisa) {
+                vector<int> tmp;
+                for (auto& c : copias) {
+                    tmp.push_back(f.newTemp(f.temps[c.first]));
+                    copiar(tmp.back(), c.second);
+                }
+                for (size_t i = 0; i < copias.size(); ++i) copiar(copias[i].first, tmp[i]);
+            } else {
+                for (auto& c : copias) copiar(c.first, c.second);
+            }
+            pred.insts.insert(pred.insts.begin() + antesDelFinal(pred), make_move_iterator(nuevas.begin()),
+                              make_move_iterator(nuevas.end()));
+        }
+        blk.insts.erase(blk.insts.begin(), blk.insts.begin() + nphi);
+    }
+}
+
+void optimizarIr(IrFunction& f) {
+    construirSsa(f);
+    propagarConstantes(f);
+    eliminarCodigoMuerto(f);
+    destruirSsa(f);
+    f.buildCfg();
+}
@@ -0,0 +1,26 @@
+#ifndef SSA_H
+#define SSA_H
+// forma ssa sobre el ir de una funcion y las pasadas que trabajan en ella.
+// las locales (y los temporales asignados en mas de un bloque, como el
+// resultado de un ternario) pasan a temporales con phi en las juntas; las
+// globales quedan en memoria porque cualquier llamada puede cambiarlas.
+
+#include "ir.h"
+
+using namespace std;
+
+void construirSsa(IrFunction& f);
+// propagacion de constantes condicional dispersa (wegman-zadeck): pliega los
+// temporales que son constantes por todos los caminos alcanzables, cambia los
+// br de condicion conocida por jmp y descarta los bloques que quedan muertos
+void propagarConstantes(IrFunction& f);
+// borra las instrucciones sin efecto cuyo resultado nadie usa
+void eliminarCodigoMuerto(IrFunction& f);
+// saca los phi: copias al final de cada predecesor (partiendo las aristas
+// criticas), de nuevo sin restricciones de asignacion unica
+void destruirSsa(IrFunction& f);
+
+// las cuatro en orden; el ir queda listo para el backend
+void optimizarIr(IrFunction& f);
+
+#endif // SSA_H
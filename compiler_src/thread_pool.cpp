@@ -0,0 +1,63 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned n) {
+    if (n == 0) n = thread::hardware_concurrency();
+    if (n == 0) n = 1;
+    for (unsigned w = 1; w < n; ++w) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(mtx);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& t : threads) t.join();
+}
+
+void ThreadPool::runJob(unsigned worker) {
+    // cada hilo toma el siguiente indice libre hasta agotarlos
+    for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+        (*job)(i, worker);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    unsigned seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(mtx);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runJob(worker);
+        {
+            lock_guard<mutex> lock(mtx);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const function<void(size_t, unsigned)>& fn) {
+    if (n == 0) return;
+    if (threads.empty() || n == 1) {
+        for (size_t i = 0; i < n; ++i) fn(i, 0);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mtx);
+        job = &fn;
+        count = n;
+        next = 0;
+        busy = static_cast<unsigned>(threads.size());
+        ++generation;
+    }
+    wake.notify_all();
+    runJob(0);
+    unique_lock<mutex> lock(mtx);
+    done.wait(lock, [&] { return busy == 0; });
+    job = nullptr;
+}
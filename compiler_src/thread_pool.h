@@ -0,0 +1,49 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+// pool fijo de hilos para repartir trabajo independiente (ej. una tarea por
+// funcion). el hilo que llama tambien trabaja y espera a que todo termine.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class ThreadPool {
+private:
+    vector<thread> threads;
+    mutex mtx;
+    condition_variable wake;
+    condition_variable done;
+
+    // trabajo en curso: indices [0, count) repartidos con next
+    const function<void(size_t, unsigned)>* job = nullptr;
+    size_t count = 0;
+    atomic<size_t> next{0};
+    unsigned busy = 0;        // hilos del pool aun dentro del trabajo actual
+    unsigned generation = 0;  // cambia con cada trabajo nuevo
+    bool stopping = false;
+
+    void workerLoop(unsigned worker);
+    void runJob(unsigned worker);
+
+public:
+    // n hilos en total contando al llamador; 0 = uno por nucleo
+    explicit ThreadPool(unsigned n = 0);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    unsigned size() const { return static_cast<unsigned>(threads.size()) + 1; }
+
+    // Ejecuta fn(i, worker) para cada i en [0, n) y vuelve cuando terminaron
+    // todos. worker esta en [0, size()) y sirve para indexar estado por hilo
+    // (0 es el llamador). fn no debe lanzar excepciones. No es reentrante.
+    void parallelFor(size_t n, const function<void(size_t, unsigned)>& fn);
+};
+
+#endif // THREAD_POOL_H
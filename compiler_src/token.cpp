@@ -4,10 +4,7 @@ using namespace std;
 Token::Token(Type type, int line, int col)
     : type(type), text(""), line(line), col(col) {}
 
-Token::Token(Type type, char c, int line, int col)
-    : type(type), text(1, c), line(line), col(col) {}
-
-Token::Token(Type type, const string& source, int first, int last, int line, int col)
+Token::Token(Type type, string_view source, int first, int last, int line, int col)
     : type(type), text(source.substr(first, last - first)), line(line), col(col) {}
 
 ostream& operator<<(ostream& outs, const Token& tok) {
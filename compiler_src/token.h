@@ -2,8 +2,10 @@
 #define TOKEN_H
 
 #include <string>
+#include <string_view>
 #include <ostream>
 using namespace std;
+// token como valor pequeño (tipo, vista al lexema, posicion): se copia sin asignar memoria
 class Token {
 public:
     // Tipos de token
@@ -56,13 +58,13 @@ public:
     };
 
     Type type;
-    string text;
+    string_view text; // vista del lexema dentro del buffer fuente (no se copia)
     int line;
     int col;
 
+    Token() : type(END), line(-1), col(-1) {}
     Token(Type type, int line = -1, int col = -1);
-    Token(Type type, char c, int line = -1, int col = -1);
-    Token(Type type, const string& source, int first, int last, int line = -1, int col = -1);
+    Token(Type type, string_view source, int first, int last, int line = -1, int col = -1);
 
     friend ostream& operator<<(ostream& outs, const Token& tok);
     friend ostream& operator<<(ostream& outs, const Token* tok);
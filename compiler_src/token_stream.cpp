@@ -0,0 +1,289 @@
+#include "token_stream.h"
+#include "keywords.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// ======================================================================
+//   Kernels SIMD
+// ======================================================================
+// cada kernel devuelve una mascara de bits (1 por byte) con los bytes que
+// continuan la corrida; la corrida termina en el primer bit en 0.
+
+#if defined(__AVX2__)
+struct Simd {
+    using V = __m256i;
+    static const size_t W = 32;
+    static const uint32_t FULL = 0xFFFFFFFFu;
+    static V load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const V*>(p)); }
+    static V set1(char c) { return _mm256_set1_epi8(c); }
+    static V eq(V a, V b) { return _mm256_cmpeq_epi8(a, b); }
+    static V orv(V a, V b) { return _mm256_or_si256(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_epi8(a, b); }
+    static V leu(V a, char k) { return eq(_mm256_min_epu8(a, set1(k)), a); } // a <= k sin signo
+    static uint32_t mask(V a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+};
+#elif defined(__SSE2__)
+struct Simd {
+    using V = __m128i;
+    static const size_t W = 16;
+    static const uint32_t FULL = 0xFFFFu;
+    static V load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const V*>(p)); }
+    static V set1(char c) { return _mm_set1_epi8(c); }
+    static V eq(V a, V b) { return _mm_cmpeq_epi8(a, b); }
+    static V orv(V a, V b) { return _mm_or_si128(a, b); }
+    static V sub(V a, V b) { return _mm_sub_epi8(a, b); }
+    static V leu(V a, char k) { return eq(_mm_min_epu8(a, set1(k)), a); }
+    static uint32_t mask(V a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+};
+#endif
+
+// clases de caracteres (mismo criterio que isspace/isalnum en locale "C")
+static inline bool isSpaceChar(unsigned char c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+static inline bool isDigitChar(unsigned char c) { return static_cast<unsigned>(c - '0') < 10u; }
+static inline bool isAlphaChar(unsigned char c) { return static_cast<unsigned>((c | 0x20) - 'a') < 26u; }
+static inline bool isIdentChar(unsigned char c) { return isAlphaChar(c) || isDigitChar(c) || c == '_'; }
+static inline bool isStringChar(unsigned char c) { return c != '"' && c != '\n'; }
+
+#if defined(__SSE2__)
+struct SpaceMask {
+    static uint32_t simd(Simd::V x) {
+        Simd::V ctl = Simd::leu(Simd::sub(x, Simd::set1('\t')), '\r' - '\t');
+        return Simd::mask(Simd::orv(ctl, Simd::eq(x, Simd::set1(' '))));
+    }
+    static bool scalar(unsigned char c) { return isSpaceChar(c); }
+};
+struct DigitMask {
+    static uint32_t simd(Simd::V x) { return Simd::mask(Simd::leu(Simd::sub(x, Simd::set1('0')), 9)); }
+    static bool scalar(unsigned char c) { return isDigitChar(c); }
+};
+struct IdentMask {
+    static uint32_t simd(Simd::V x) {
+        Simd::V alpha = Simd::leu(Simd::sub(Simd::orv(x, Simd::set1(0x20)), Simd::set1('a')), 25);
+        Simd::V digit = Simd::leu(Simd::sub(x, Simd::set1('0')), 9);
+        return Simd::mask(Simd::orv(Simd::orv(alpha, digit), Simd::eq(x, Simd::set1('_'))));
+    }
+    static bool scalar(unsigned char c) { return isIdentChar(c); }
+};
+struct StringMask {
+    static uint32_t simd(Simd::V x) {
+        return ~Simd::mask(Simd::orv(Simd::eq(x, Simd::set1('"')), Simd::eq(x, Simd::set1('\n')))) & Simd::FULL;
+    }
+    static bool scalar(unsigned char c) { return isStringChar(c); }
+};
+
+// avanza i mientras los bytes pertenezcan a la clase M
+template <typename M>
+static inline size_t scanRun(const char* s, size_t i, size_t n) {
+    if (i < n && !M::scalar(static_cast<unsigned char>(s[i]))) return i; // corridas vacias: sin SIMD
+    while (i + Simd::W <= n) {
+        uint32_t m = M::simd(Simd::load(s + i));
+        if (m != Simd::FULL) return i + __builtin_ctz(~m);
+        i += Simd::W;
+    }
+    while (i < n && M::scalar(static_cast<unsigned char>(s[i]))) ++i;
+    return i;
+}
+
+// agrega a starts el inicio de cada linea que empieza en [from, to)
+static inline void markLines(const char* s, size_t from, size_t to, vector<uint32_t>& starts) {
+    size_t i = from;
+    while (i + Simd::W <= to) {
+        for (uint32_t m = Simd::mask(Simd::eq(Simd::load(s + i), Simd::set1('\n'))); m; m &= m - 1) {
+            starts.push_back(static_cast<uint32_t>(i + __builtin_ctz(m) + 1));
+        }
+        i += Simd::W;
+    }
+    for (; i < to; ++i) {
+        if (s[i] == '\n') starts.push_back(static_cast<uint32_t>(i + 1));
+    }
+}
+#else
+// sin SIMD (arquitecturas no x86): mismas corridas byte a byte
+struct SpaceMask  { static bool scalar(unsigned char c) { return isSpaceChar(c); } };
+struct DigitMask  { static bool scalar(unsigned char c) { return isDigitChar(c); } };
+struct IdentMask  { static bool scalar(unsigned char c) { return isIdentChar(c); } };
+struct StringMask { static bool scalar(unsigned char c) { return isStringChar(c); } };
+
+template <typename M>
+static inline size_t scanRun(const char* s, size_t i, size_t n) {
+    while (i < n && M::scalar(static_cast<unsigned char>(s[i]))) ++i;
+    return i;
+}
+
+static inline void markLines(const char* s, size_t from, size_t to, vector<uint32_t>& starts) {
+    for (size_t i = from; i < to; ++i) {
+        if (s[i] == '\n') starts.push_back(static_cast<uint32_t>(i + 1));
+    }
+}
+#endif
+
+// ======================================================================
+//   TokenStream
+// ======================================================================
+
+void TokenStream::resize(size_t n) {
+    kind.resize(n);
+    offset.resize(n);
+    length.resize(n);
+    line.resize(n);
+}
+
+Token TokenStream::at(size_t i) const {
+    if (i >= size()) i = size() - 1;
+    uint32_t col = offset[i] - lineStart[line[i] - 1] + 1;
+    return Token(static_cast<Token::Type>(kind[i]), source, static_cast<int>(offset[i]),
+                 static_cast<int>(offset[i] + length[i]), static_cast<int>(line[i]), static_cast<int>(col));
+}
+
+// ======================================================================
+//   tokenizeAll: mismas reglas que Scanner::nextToken
+// ======================================================================
+// la linea no se actualiza por byte: solo se buscan los '\n' de los tramos
+// saltados (espacios, comentarios, preprocesador).
+//
+// guardar los tokens cuesta mas que reconocerlos, asi que los arreglos no
+// crecen con push_back (un control de capacidad por arreglo y por token):
+// se agranda de a CHUNK tokens y se escribe por indice. la reserva inicial
+// alcanza para el codigo tipico (~0.27 tokens por byte) y no toca memoria,
+// asi que casi nunca hay que copiar todo al pasarse.
+
+TokenStream tokenizeAll(string_view src) {
+    const size_t CHUNK = 4096;
+    TokenStream ts;
+    ts.source = src;
+    ts.kind.reserve(src.size() / 3 + CHUNK);
+    ts.offset.reserve(ts.kind.capacity());
+    ts.length.reserve(ts.kind.capacity());
+    ts.line.reserve(ts.kind.capacity());
+    ts.lineStart.reserve(src.size() / 16 + 1);
+    ts.lineStart.push_back(0);
+
+    const char* s = src.data();
+    const size_t n = src.size();
+    size_t i = 0;
+    size_t count = 0;   // tokens escritos
+    size_t limit = 0;   // tamaño actual de los arreglos
+    uint8_t* kind = nullptr;
+    uint32_t *offset = nullptr, *length = nullptr, *line = nullptr;
+
+    auto put = [&](Token::Type k, size_t first, size_t len) {
+        if (count == limit) {
+            limit += CHUNK;
+            ts.resize(limit);
+            kind = ts.kind.data();
+            offset = ts.offset.data();
+            length = ts.length.data();
+            line = ts.line.data();
+        }
+        kind[count] = static_cast<uint8_t>(k);
+        offset[count] = static_cast<uint32_t>(first);
+        length[count] = static_cast<uint32_t>(len);
+        line[count] = static_cast<uint32_t>(ts.lineStart.size());
+        ++count;
+    };
+    auto skipLines = [&](size_t from, size_t to) { markLines(s, from, to, ts.lineStart); };
+    auto emit = [&](Token::Type k, size_t first) { put(k, first, i - first); };
+
+    while (true) {
+        size_t ws = i;
+        i = scanRun<SpaceMask>(s, i, n);
+        skipLines(ws, i);
+
+        if (i >= n) {
+            put(Token::END, n, 0);
+            break;
+        }
+
+        size_t first = i;
+        char c = s[i];
+
+        // comentarios // y /* */
+        if (c == '/' && i + 1 < n) {
+            if (s[i + 1] == '/') {
+                const void* nl = memchr(s + i, '\n', n - i);
+                i = nl ? static_cast<const char*>(nl) - s : n;
+                continue;
+            }
+            if (s[i + 1] == '*') {
+                size_t close = src.find("*/", i + 2);
+                // sin cierre el scanner deja el ultimo byte sin consumir
+                size_t end = (close == string_view::npos) ? (n - 1 > i + 2 ? n - 1 : i + 2) : close + 2;
+                skipLines(i, end);
+                i = end;
+                continue;
+            }
+        }
+
+        // linea de preprocesador: hasta el '\n' inclusive
+        if (c == '#') {
+            const void* nl = memchr(s + i, '\n', n - i);
+            size_t end = nl ? static_cast<const char*>(nl) - s + 1 : n;
+            skipLines(i, end);
+            i = end;
+            continue;
+        }
+
+        // literales de cadena "..."
+        if (c == '"') {
+            i = scanRun<StringMask>(s, i + 1, n);
+            if (i < n && s[i] == '"') ++i;
+            emit(Token::STRING, first);
+            continue;
+        }
+
+        // numeros: digitos, fraccion opcional y sufijo de tipo
+        if (isDigitChar(static_cast<unsigned char>(c))) {
+            i = scanRun<DigitMask>(s, i + 1, n);
+            if (i + 1 < n && s[i] == '.' && isDigitChar(static_cast<unsigned char>(s[i + 1]))) {
+                i = scanRun<DigitMask>(s, i + 1, n);
+            }
+            if (i < n && (s[i] == 'L' || s[i] == 'l' || s[i] == 'U' || s[i] == 'u' ||
+                          s[i] == 'F' || s[i] == 'f')) {
+                ++i; // sufijo de tipo
+            }
+            emit(Token::NUM, first);
+            continue;
+        }
+
+        // identificadores y palabras clave
+        if (isAlphaChar(static_cast<unsigned char>(c)) || c == '_') {
+            i = scanRun<IdentMask>(s, i + 1, n);
+            emit(keywords::lookup(src.substr(first, i - first)), first);
+            continue;
+        }
+
+        // operadores y signos de puntuacion
+        ++i;
+        Token::Type k;
+        switch (c) {
+            case '+': k = Token::PLUS; break;
+            case '-': k = Token::MINUS; break;
+            case '*':
+                if (i < n && s[i] == '*') { ++i; k = Token::POW; }
+                else k = Token::MUL;
+                break;
+            case '/': k = Token::DIV; break;
+            case '%': k = Token::MOD; break;
+            case '(': k = Token::LPAREN; break;
+            case ')': k = Token::RPAREN; break;
+            case '{': k = Token::LBRACE; break;
+            case '}': k = Token::RBRACE; break;
+            case ';': k = Token::SEMICOL; break;
+            case ',': k = Token::COMA; break;
+            case '<': k = Token::LE; break;
+            case '>': k = Token::GT; break;
+            case '=': k = Token::ASSIGN; break;
+            case '?': k = Token::QMARK; break;
+            case ':': k = Token::COL; break;
+            case '\\': k = Token::BACKSLASH; break;
+            case '.': k = Token::DOT; break;
+            default:  k = Token::ERR; break; // carácter no reconocido
+        }
+        emit(k, first);
+    }
+    ts.resize(count);
+    return ts;
+}
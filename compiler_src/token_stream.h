@@ -0,0 +1,35 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+// lexing por lotes: tokeniza todo el buffer de una vez en arreglos paralelos
+// (structure-of-arrays). los saltos de espacios, comentarios y las corridas de
+// identificadores/digitos usan kernels SSE2/AVX2 en vez de avanzar byte a byte.
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "token.h"
+
+using namespace std;
+
+class TokenStream {
+public:
+    string_view source;       // buffer del llamador, los lexemas apuntan aqui
+    vector<uint8_t>  kind;    // Token::Type
+    vector<uint32_t> offset;  // inicio del lexema en source
+    vector<uint32_t> length;
+    vector<uint32_t> line;
+    // offset del primer byte de cada linea (la linea l en [l - 1]). la
+    // columna sale de aqui en at(): un arreglo por linea en vez de por token
+    vector<uint32_t> lineStart;
+
+    size_t size() const { return kind.size(); }
+    void resize(size_t n);
+
+    // Token i como valor; fuera de rango devuelve el END final
+    Token at(size_t i) const;
+};
+
+// Tokeniza src completo. El ultimo token siempre es END.
+TokenStream tokenizeAll(string_view src);
+
+#endif // TOKEN_STREAM_H
@@ -0,0 +1,119 @@
+import os
+import glob
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# verifica que la compilacion incremental y la paralela no cambien nada:
+#  - con --session, compilar un archivo editado debe dejar exactamente lo
+#    mismo (.s, stack json y mapa asm) que compilarlo desde cero
+#  - -j 1 y -j 4 deben dejar las mismas salidas, por archivo y por lote
+#
+# uso: python3 verificar_incremental.py [binario]
+# (el binario por defecto es ./a.out, el que deja run_all_inputs.py; si no
+# existe se compila)
+
+SALIDAS = [".s", "_stack.json", "_stack.json.asm.json"]
+
+
+def compilar(binario, args, carpeta, nombres):
+    """corre el compilador en carpeta y devuelve (y borra) lo que dejo cada entrada"""
+    subprocess.run([binario] + args + nombres, cwd=carpeta, capture_output=True, timeout=60)
+    res = []
+    for nombre in nombres:
+        base = os.path.join(carpeta, nombre[:-4])
+        for ext in SALIDAS:
+            p = base + ext
+            if os.path.exists(p):
+                with open(p) as f:
+                    res.append(f.read())
+                os.remove(p)
+            else:
+                res.append(None)
+    return res
+
+
+def ediciones(texto, rnd):
+    """versiones editadas de texto: lineas corridas, funciones nuevas, cambios en el cuerpo"""
+    lineas = texto.split("\n")
+    res = ["\n" + texto, "\n\n\n" + texto]
+    for _ in range(4):
+        i = rnd.randrange(len(lineas))
+        res.append("\n".join(lineas[:i] + [""] + lineas[i:]))
+    res.append("int extra_fn(int q) {\n    return q + 1;\n}\n" + texto)
+    res.append(texto.replace("1", "2", 1))
+    res.append(texto.replace("+", "-", 1))
+    return res
+
+
+def escribir(carpeta, nombre, texto):
+    with open(os.path.join(carpeta, nombre), "w") as f:
+        f.write(texto)
+
+
+def main():
+    binario = os.path.abspath(sys.argv[1] if len(sys.argv) > 1 else "a.out")
+    if not os.path.isfile(binario):
+        fuentes = sorted(glob.glob("*.cpp"))
+        print("Compilando:", binario)
+        r = subprocess.run(["g++", "-std=c++17", "-pthread"] + fuentes + ["-o", binario],
+                           capture_output=True, text=True)
+        if r.returncode != 0:
+            print("Error en compilación:\n", r.stderr)
+            exit(1)
+
+    entradas = sorted(glob.glob(os.path.join("inputs", "input*.txt")))
+    rnd = random.Random(1)
+    tmp = tempfile.mkdtemp()
+    fallas = 0
+    try:
+        # sesion: editar y recompilar contra el estado de la version anterior
+        casos = 0
+        for entrada in entradas:
+            with open(entrada) as f:
+                original = f.read()
+            for k, editado in enumerate(ediciones(original, rnd)):
+                escribir(tmp, "a.txt", editado)
+                desde_cero = compilar(binario, [], tmp, ["a.txt"])
+                if desde_cero[0] is None:
+                    continue  # la edicion rompio el programa
+                sesion = ["--session", "estado"]
+                if os.path.exists(os.path.join(tmp, "estado")):
+                    os.remove(os.path.join(tmp, "estado"))
+                escribir(tmp, "a.txt", original)
+                compilar(binario, sesion, tmp, ["a.txt"])
+                escribir(tmp, "a.txt", editado)
+                primera = compilar(binario, sesion, tmp, ["a.txt"])
+                segunda = compilar(binario, sesion, tmp, ["a.txt"])
+                casos += 1
+                if primera != desde_cero or segunda != desde_cero:
+                    fallas += 1
+                    print(f"sesion: {entrada} edicion {k} no coincide con compilar desde cero")
+        print(f"sesion: {casos} ediciones comparadas")
+
+        # -j: por archivo (funciones en paralelo) y por lote (archivos en paralelo)
+        nombres = []
+        for entrada in entradas:
+            nombres.append(os.path.basename(entrada))
+            shutil.copy(entrada, os.path.join(tmp, nombres[-1]))
+        serie = [compilar(binario, ["-j", "1"], tmp, [n]) for n in nombres]
+        for n, esperado in zip(nombres, serie):
+            if compilar(binario, ["-j", "4"], tmp, [n]) != esperado:
+                fallas += 1
+                print(f"-j: {n} cambia con -j 4")
+        lote = compilar(binario, ["-j", "4"], tmp, nombres)
+        if lote != [s for r in serie for s in r]:
+            fallas += 1
+            print("-j: el lote con -j 4 no coincide con compilar cada archivo solo")
+        print(f"-j: {len(nombres)} archivos comparados")
+    finally:
+        shutil.rmtree(tmp)
+
+    print("ok" if not fallas else f"{fallas} fallas")
+    exit(1 if fallas else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -2,8 +2,15 @@
 #include <unordered_map>
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include "ast.h"
+#include "ast_walk.h"
+#include "ir.h"
+#include "peephole.h"
+#include "ssa.h"
+#include "thread_pool.h"
 #include "visitor.h"
+#include "x86_backend.h"
 
 using namespace std;
 
@@ -11,7 +18,7 @@ using namespace std;
 //   Utilidades
 // ======================================================================
 // emit escribe asm y lo guarda por linea en asmByLine para la visualizacion
-// sizeOfType usa slots de 8 bytes para evitar solapamientos; is32Bit decide movq/movl
+// sizeOfType usa slots de 8 bytes para evitar solapamientos
 
 static bool tryParseLong(const string& s, long long& out) {
     if (s.empty()) return false;
@@ -24,6 +31,74 @@ static bool tryParseLong(const string& s, long long& out) {
     }
 }
 
+// expresion sin variables ni llamadas: constEval la calcula sin depender de
+// currentVars, que sigue el orden de visita y no el flujo del programa
+static bool esLiteral(Exp* e) {
+    switch (e->kind) {
+    case NUMBER_EXP:
+        return static_cast<NumberExp*>(e)->literalType != Type::FLOAT;
+    case BOOL_EXP:
+        return true;
+    case BINARY_EXP: {
+        auto bin = static_cast<BinaryExp*>(e);
+        return esLiteral(bin->left) && esLiteral(bin->right);
+    }
+    default:
+        return false;
+    }
+}
+
+// etiqueta de sethi-ullman de e: cuantos temporales tienen que estar vivos a
+// la vez para evaluarlo si cada operacion empieza por su lado mas pesado.
+// queda en e->registros (y e->llamadas), asi cada nodo se calcula una vez
+static int registrosNecesarios(Exp* e) {
+    if (e->registros > 0) return e->registros;
+    int n = 1;
+    switch (e->kind) {
+    case BINARY_EXP: {
+        auto bin = static_cast<BinaryExp*>(e);
+        int l = registrosNecesarios(bin->left), r = registrosNecesarios(bin->right);
+        n = l == r ? l + 1 : max(l, r);
+        e->llamadas = bin->left->llamadas || bin->right->llamadas;
+        break;
+    }
+    case TERNARY_EXP: {
+        // la condicion muere en el salto y solo se evalua una rama
+        auto ter = static_cast<TernaryExp*>(e);
+        n = max(registrosNecesarios(ter->condition),
+                max(registrosNecesarios(ter->thenExp), registrosNecesarios(ter->elseExp)));
+        e->llamadas = ter->condition->llamadas || ter->thenExp->llamadas || ter->elseExp->llamadas;
+        break;
+    }
+    case FCALL_EXP: {
+        // el i-esimo argumento evaluado convive con los i anteriores; sin
+        // llamadas adentro van de mas pesado a mas liviano (ver visit(FcallExp*))
+        auto call = static_cast<FcallExp*>(e);
+        vector<int> pesos;
+        bool puros = true;
+        for (Exp* a : call->argumentos) {
+            pesos.push_back(registrosNecesarios(a));
+            puros = puros && !a->llamadas;
+        }
+        if (puros) sort(pesos.begin(), pesos.end(), greater<int>());
+        for (size_t i = 0; i < pesos.size(); ++i) n = max(n, pesos[i] + (int)i);
+        e->llamadas = true;
+        break;
+    }
+    default:
+        break;
+    }
+    return e->registros = n;
+}
+
+// variables leidas en algun punto del cuerpo (incluye inicializadores y las
+// partes de un for); las demas locales no reciben slot en el stack
+struct UsedVarsCollector : AstWalker<UsedVarsCollector> {
+    using AstWalker<UsedVarsCollector>::visit;
+    unordered_set<Symbol>& used;
+    void visit(IdExp* e) { used.insert(e->value); }
+};
+
 static string jsonEscape(const string& s) {
     string r;
     r.reserve(s.size() + 8);
@@ -47,29 +122,11 @@ static int sizeOfType(const string& t) {
     return 8; // long y por defecto
 }
 
-static bool is32Bit(const string& t) {
-    return (t == "bool" || t == "int" || t == "unsigned int" || t == "float");
-}
-
-static bool isUnsigned(const string& t) {
-    return (t == "unsigned int");
-}
-
-static bool isFloatType(const string& t) {
-    return (t == "float");
-}
-
-static string getVarType(const map<string, FrameVar>& vars, const string& name) {
-    auto it = vars.find(name);
-    if (it != vars.end()) return it->second.type;
-    return "int";
-}
-
-static string findGlobalType(const Frame& globals, const string& name) {
-    for (const auto& fv : globals.vars) {
-        if (fv.name == name) return fv.type;
-    }
-    return "int";
+static const string& findGlobalType(const unordered_map<Symbol, string>& globals, Symbol name) {
+    static const string defaultType = "int";
+    auto it = globals.find(name);
+    if (it != globals.end()) return it->second;
+    return defaultType;
 }
 
 // ======================================================================
@@ -106,9 +163,92 @@ int GenCodeVisitor::generar(Program* program) { // Funcion auxiliar inicial
     return 0;
 }
 
+void GenCodeVisitor::generarFuncion(FunDec* fd) {
+    enlazarFuncion(compilarFuncion(fd));
+    out.flush(); // la funcion queda completa en el .s
+}
+
+FunctionCode GenCodeVisitor::compilarFuncion(FunDec* fd) {
+    // contadores locales desde 0; los globales solo avanzan al enlazar
+    IrFunction func;
+    func.names = names;
+    int savedLabels = labelcont, savedSnaps = snapshotCounter;
+    labelcont = snapshotCounter = 0;
+    ir = &func;
+    bloque = -1;
+    ordenBloques.clear();
+    fd->accept(this);
+    // los bloques se crean antes de saber donde van (ej. endif_ al empezar
+    // el if); quedan en el orden en que se empezaron
+    func.reorderBlocks(ordenBloques);
+    ir = nullptr;
+    bloque = -1;
+    func.labelCount = labelcont;
+    func.endLine = currentLine;
+    labelcont = savedLabels;
+    snapshotCounter = savedSnaps;
+    optimizarIr(func);
+    FunctionCode code = emitirX86(func);
+    code.peephole = optimizarPeephole(code);
+    return code;
+}
+
+vector<FunctionCode> GenCodeVisitor::compilarFunciones(const vector<FunDec*>& fds, ThreadPool& pool) {
+    vector<FunctionCode> codes(fds.size());
+    // el hilo llamador usa este visitor; los demas, uno propio con solo los
+    // nombres y las globales, que es lo unico de programa que lee una funcion
+    // (el asm y los snapshots ya enlazados no se copian)
+    vector<unique_ptr<GenCodeVisitor>> workers(pool.size());
+    pool.parallelFor(fds.size(), [&](size_t i, unsigned w) {
+        if (w != 0 && !workers[w]) {
+            workers[w].reset(new GenCodeVisitor(out));
+            workers[w]->names = names;
+            workers[w]->memoriaGlobal = memoriaGlobal;
+            workers[w]->globalTypes = globalTypes;
+        }
+        GenCodeVisitor& gen = w == 0 ? *this : *workers[w];
+        codes[i] = gen.compilarFuncion(fds[i]);
+    });
+    return codes;
+}
+
+void GenCodeVisitor::enlazarFuncion(const FunctionCode& code, int lineDelta) {
+    auto reloc = [lineDelta](int line) { return line >= 0 ? line + lineDelta : line; };
+    int labelBase = labelcont, snapBase = snapshotCounter;
+    for (const CodeLine& cl : code.lines) {
+        int line = reloc(cl.line);
+        if (cl.kind == CodeLine::SNAP) {
+            out << "# SNAPIDX " << snapBase + cl.num << " " << cl.text;
+            if (line > 0) out << " line " << line;
+            out << "\n";
+            continue;
+        }
+        if (cl.kind == CodeLine::LABEL) {
+            string instr = cl.text + to_string(labelBase + cl.num) + cl.suffix;
+            out << instr << '\n';
+            if (line >= -1) asmByLine[line].push_back(instr);
+            continue;
+        }
+        out << cl.text << '\n';
+        if (line >= -1) asmByLine[line].push_back(cl.text);
+    }
+    for (const Snapshot& s : code.snapshots) {
+        snapshots.push_back(Snapshot{s.label, s.vars, reloc(s.line), snapBase + s.idx, s.func});
+    }
+    labelcont += code.labelCount;
+    snapshotCounter += (int)code.snapshots.size();
+    currentLine = reloc(code.endLine);
+}
+
+void GenCodeVisitor::terminarPrograma() {
+    cerrarAsm();
+    saveStack();
+    saveAsmMap();
+}
+
 void GenCodeVisitor::emit(const string& instr, int lineOverride) { // escribe asm
     int line = (lineOverride >= 0) ? lineOverride : currentLine; // linea actual
-    out << instr << endl; // el out de siempre
+    out << instr << '\n';
     // guardamos tambien prologo (-1) para que aparezca en front
     if (line >= -1) {
         asmByLine[line].push_back(instr);
@@ -116,16 +256,14 @@ void GenCodeVisitor::emit(const string& instr, int lineOverride) { // escribe as
 }
 
 void GenCodeVisitor::saveStack() {
-    if (stackPath.empty()) return;
+    if (!stackOut) return;
 
     // si no hay snapshots, al menos guardar globals
     if (snapshots.empty() && !globalFrame.vars.empty()) {
         snapshots.push_back(Snapshot{"globals", globalFrame.vars, 0, snapshotCounter++, "global"});
     }
 
-    ofstream json(stackPath, ios::trunc); // sobrescribe
-    if (!json.is_open()) return;
-
+    ostream& json = *stackOut;
     json << "[";
     for (size_t i = 0; i < snapshots.size(); ++i) {
         const auto& fr = snapshots[i];
@@ -144,12 +282,9 @@ void GenCodeVisitor::saveStack() {
 }
 
 void GenCodeVisitor::saveAsmMap() {
-    if (stackPath.empty()) return;
+    if (!asmMapOut) return;
     // asmByLine sale de emit: agrupa instrucciones por linea de codigo fuente
-    // se escribe en stackPath+".asm.json" para que el front lo use directo
-    string asmMapPath = stackPath + ".asm.json";
-    ofstream json(asmMapPath, ios::trunc);
-    if (!json.is_open()) return;
+    ostream& json = *asmMapOut;
     json << "{";
     bool first = true;
     for (const auto& kv : asmByLine) {
@@ -184,20 +319,41 @@ int GenCodeVisitor::preAsignarOffsets(Body* body, int startOffset) {
     // luego bodys de sentencias
     // llama a preAsignarOffsets recursivamente para If, While, For, para almacenar variables locales anidadas
     for (auto s : body->StmList) {
-        if (auto ifs = dynamic_cast<IfStm*>(s)) { // dynamic cast para ver si es IfStm
-            if (ifs->then) localOffset = preAsignarOffsets(ifs->then, localOffset); // cuerpo then
-            if (ifs->els)  localOffset = preAsignarOffsets(ifs->els,  localOffset); // cuerpo else
-        } else if (auto wh = dynamic_cast<WhileStm*>(s)) { // WhileStm
-            if (wh->b) localOffset = preAsignarOffsets(wh->b, localOffset);
-        } else if (auto fs = dynamic_cast<ForStm*>(s)) { // ForStm
-            if (fs->b) localOffset = preAsignarOffsets(fs->b, localOffset);
+        switch (s->kind) {
+            case IF_STM: {
+                auto ifs = static_cast<IfStm*>(s);
+                if (ifs->then) localOffset = preAsignarOffsets(ifs->then, localOffset); // cuerpo then
+                if (ifs->els)  localOffset = preAsignarOffsets(ifs->els,  localOffset); // cuerpo else
+                break;
+            }
+            case WHILE_STM: {
+                auto wh = static_cast<WhileStm*>(s);
+                if (wh->b) localOffset = preAsignarOffsets(wh->b, localOffset);
+                break;
+            }
+            case FOR_STM: {
+                auto fs = static_cast<ForStm*>(s);
+                if (fs->b) localOffset = preAsignarOffsets(fs->b, localOffset);
+                break;
+            }
+            default: break; // las demas sentencias no abren cuerpos
         }
     }
     return localOffset;
 }
 
 int GenCodeVisitor::visit(Program* program) {
+    iniciarPrograma(program);
+    for (auto dec : program->fdlist) { // funciones
+        generarFuncion(dec);
+    }
+    cerrarAsm();
+    return 0;
+}
+
+void GenCodeVisitor::iniciarPrograma(Program* program) {
     currentLine = -1;
+    names = &program->names;
     env.add_level();
     typeEnv.add_level();
     emit(".data");
@@ -211,18 +367,17 @@ int GenCodeVisitor::visit(Program* program) {
     for (auto dec : program->vdlist) { // se visitan las declaraciones globales
         dec->accept(this);
     }
-    for (auto it = memoriaGlobal.begin(); it != memoriaGlobal.end(); ++it) { // itera sobre variables globales
-        emit(it->first + ": .quad 0");
+    for (Symbol g : globalOrder) { // variables globales en orden de declaracion
+        emit(names->name(g) + ": .quad 0");
     }
 
     emit(".text"); // Empieza el coso
-    for (auto dec : program->fdlist) { // funciones
-        dec->accept(this);
-    }
+}
+
+void GenCodeVisitor::cerrarAsm() {
     emit(".section .note.GNU-stack,\"\",@progbits"); // final asm
     env.remove_level();
     typeEnv.remove_level();
-    return 0;
 }
 
 int GenCodeVisitor::visit(VarDec* vd) {
@@ -230,273 +385,219 @@ int GenCodeVisitor::visit(VarDec* vd) {
     for (auto& var : vd->vars) {
         // para Variables globales
         if (!entornoFuncion) { // si no estamos en funcion, es global
-            memoriaGlobal[var] = true;
+            if (memoriaGlobal.emplace(var, true).second) globalOrder.push_back(var);
             globalTypes[var] = vd->type;
-            FrameVar fv{var, 0, vd->type, "?"}; // offset 0 para globales, valor desconocido "?"
+            FrameVar fv{names->name(var), 0, vd->type, "?", var}; // offset 0 para globales, valor desconocido "?"
             globalFrame.vars.push_back(fv); // agrega a globalFrame
         
         // para Variables locales
         } else {
-            if (env.check(var) && currentFrame.label != "none") { // verifica que no exista ya
-                int off = env.lookup(var); // busca offset
-                FrameVar fv{var, off, vd->type, "?"};
+            const int* off = env.find(var); // offset preasignado
+            if (off && currentFrame.label != "none") { // verifica que no exista ya
+                FrameVar fv{names->name(var), *off, vd->type, "?", var};
                 currentFrame.vars.push_back(fv);
                 currentVars[var] = fv;
-                snapshot("decl " + var, vd->line); // guarda snapshot de declaracion
+                snapshot("decl " + fv.name, vd->line); // guarda snapshot de declaracion
             }
         }
     }
     return 0;
 }
 
-// Helpers de carga/almacenamiento
-static string movLoad(const string& t) {
-    if (t == "bool") return " movzbq ";
-    if (is32Bit(t)) return " movl ";
-    return " movq ";
+// ======================================================================
+//   Bajada a ir: cada visita de expresion devuelve el temporal con su valor
+// ======================================================================
+
+IrInst& GenCodeVisitor::agregar(IrOp op, IrType type, int dst, int a, int b) {
+    // codigo despues de un return: va a un bloque propio, inalcanzable
+    if (terminado()) empezarBloque(nuevoBloque());
+    IrInst in;
+    in.op = op;
+    in.type = type;
+    in.dst = dst;
+    in.a = a;
+    in.b = b;
+    in.line = currentLine < -1 ? -2 : currentLine;
+    vector<IrInst>& insts = ir->blocks[bloque].insts;
+    insts.push_back(std::move(in));
+    return insts.back();
 }
-static string movStore(const string& t) {
-    if (t == "bool") return " movb ";
-    if (is32Bit(t)) return " movl ";
-    return " movq ";
+
+int GenCodeVisitor::constante(IrType t, int64_t v) {
+    int d = ir->newTemp(t);
+    agregar(IR_CONST, t, d).imm = v;
+    return d;
+}
+
+// el valor de temp en la clase de registro de to (entero o float); un int
+// que pasa a 64 bits se extiende con signo
+int GenCodeVisitor::convertir(int temp, IrType to) {
+    IrType from = ir->temps[temp];
+    bool extender = from == IrType::I32 && (to == IrType::I64 || to == IrType::U64);
+    if (irIsFloat(from) == irIsFloat(to) && !extender) return temp;
+    int d = ir->newTemp(to);
+    agregar(IR_CVT, to, d, temp);
+    return d;
+}
+
+int GenCodeVisitor::nuevoBloque(const string& label, int num) {
+    ir->blocks.emplace_back();
+    ir->blocks.back().label = label;
+    ir->blocks.back().labelNum = num;
+    return (int)ir->blocks.size() - 1;
+}
+
+// el bloque actual cae en b si no termino con un salto
+void GenCodeVisitor::empezarBloque(int b) {
+    if (bloque >= 0) saltar(b);
+    bloque = b;
+    ir->blocks[b].line = currentLine < -1 ? -2 : currentLine;
+    ordenBloques.push_back(b);
+}
+
+bool GenCodeVisitor::terminado() const {
+    const vector<IrInst>& insts = ir->blocks[bloque].insts;
+    return !insts.empty() && insts.back().isTerminator();
+}
+
+void GenCodeVisitor::saltar(int b) {
+    if (!terminado()) agregar(IR_JMP, IrType::I64).target = b;
+}
+
+void GenCodeVisitor::bifurcar(int cond, int siCierto, int siFalso) {
+    IrInst& br = agregar(IR_BR, IrType::I64, -1, cond);
+    br.target = siCierto;
+    br.other = siFalso;
+}
+
+// memoria de s: global si hay una global con ese nombre, si no la local con
+// su offset preasignado. false si es una local sin slot (nunca se lee, asi
+// que preAsignarOffsets no le dio lugar y sus stores se descartan)
+bool GenCodeVisitor::variable(Symbol s, IrVar& v) {
+    const string* local = typeEnv.find(s);
+    v.sym = s;
+    v.type = irTypeOf(local ? *local : findGlobalType(globalTypes, s));
+    v.global = memoriaGlobal.count(s) > 0;
+    if (v.global) return true;
+    const int* off = env.find(s);
+    if (!off) return false;
+    v.offset = *off;
+    return true;
 }
 
 int GenCodeVisitor::visit(NumberExp* exp) { // para definiciones como int x = 42; float y = 3.14;
-    string t = Type::type_to_string(exp->literalType); // obtener tipo desde literalType
-    // FLOAT
-    if (isFloatType(t)) {
-        union { float f; uint32_t u; } fb; // crea fb ( float y su representacion binaria)
-        fb.f = static_cast<float>(exp->fvalue); // asigna fvalue a fb.f
-        emit(" movl $" + to_string(fb.u) + ", %eax"); // mueve la representacion binaria a eax
-        emit(" movd %eax, %xmm0"); // mueve eax a xmm0 como float
-        return 0;
-    }
-    // BOOL (forma literal numerico, 0/1)
-    if (t == "bool") {
-        emit(" movb $" + to_string(exp->value) + ", %al"); // carga el valor en al (que tiene 1 byte)
-        emit(" movzbq %al, %rax"); // extiende 0 a 64 bits y lo guarda en rax
-        return 0;
-    }
-    // INT, LONG, UINT
-    if (is32Bit(t)) { // 4 bytes
-        emit(" movl $" + to_string(exp->value) + ", %eax");
-    } else { // 8 bytes
-        emit(" movq $" + to_string(exp->value) + ", %rax");
+    IrType t = irTypeOf(exp->literalType);
+    if (irIsFloat(t)) {
+        union { float f; uint32_t u; } fb; // representacion binaria del float
+        fb.f = static_cast<float>(exp->fvalue);
+        return constante(t, fb.u);
     }
-    return 0;
+    return constante(t, exp->value);
 }
 
 int GenCodeVisitor::visit(BoolExp* exp) {
-    emit(" movb $" + to_string(exp->valor) + ", %al");
-    emit(" movzbq %al, %rax");
-    return 0;
+    return constante(IrType::BOOL, exp->valor);
 }
 
 int GenCodeVisitor::visit(IdExp* exp) {
-    string t = typeEnv.check(exp->value) ? typeEnv.lookup(exp->value) : findGlobalType(globalFrame, exp->value);
-    if (isFloatType(t)) {
-        if (memoriaGlobal.count(exp->value))
-            emit(" movss " + exp->value + "(%rip), %xmm0");
-        else
-            emit(" movss " + to_string(env.lookup(exp->value)) + "(%rbp), %xmm0");
-        return 0;
-    }
-    if (t == "bool") {
-        if (memoriaGlobal.count(exp->value))
-            emit(" movzbq " + exp->value + "(%rip), %rax");
-        else
-            emit(" movzbq " + to_string(env.lookup(exp->value)) + "(%rbp), %rax");
-        return 0;
-    }
-    bool use32 = is32Bit(t);
-    if (memoriaGlobal.count(exp->value)) {
-        emit(string(use32 ? " movl " : " movq ") + exp->value + "(%rip), " + (use32 ? "%eax" : "%rax"));
-    } else {
-        int off = env.lookup(exp->value);
-        emit(string(use32 ? " movl " : " movq ") + to_string(off) + "(%rbp), " + (use32 ? "%eax" : "%rax"));
-    }
-    return 0;
+    IrVar v;
+    variable(exp->value, v);
+    int d = ir->newTemp(v.type);
+    agregar(IR_LOAD, v.type, d).var = v;
+    return d;
 }
 
 int GenCodeVisitor::visit(BinaryExp* exp) {
-    // Intento de plegado general: si constEval devuelve un numero, usarlo.
-    string vstr = constEval(exp);
+    // el plegado de constantes lo hace propagarConstantes sobre el ir; pow
+    // no tiene instruccion y solo se calcula entre literales
     long long v;
-    if (tryParseLong(vstr, v)) {
-        exp->cont = 1;
-        exp->valor = static_cast<int>(v);
-        if (v >= INT32_MIN && v <= INT32_MAX) {
-            emit(" movl $" + to_string(v) + ", %eax");
-        } else {
-            emit(" movq $" + to_string(v) + ", %rax");
-        }
-        return 0;
-    }
-
-    // Solo plegamos cuando ambos lados son literales (NumberExp/BoolExp) para
-    // evitar usar valores de runtime almacenados en currentVars.
-    bool leftLit  = dynamic_cast<NumberExp*>(exp->left) || dynamic_cast<BoolExp*>(exp->left);
-    bool rightLit = dynamic_cast<NumberExp*>(exp->right) || dynamic_cast<BoolExp*>(exp->right);
-    if (leftLit && rightLit) {
-        string lstr = constEval(exp->left);
-        string rstr = constEval(exp->right);
-        long long lval, rval;
-        if (tryParseLong(lstr, lval) && tryParseLong(rstr, rval)) {
-            long long res = 0;
-            bool ok = true;
-            switch (exp->op) {
-                case PLUS_OP:  res = lval + rval; break;
-                case MINUS_OP: res = lval - rval; break;
-                case MUL_OP:   res = lval * rval; break;
-                case DIV_OP:   if (rval == 0) ok = false; else res = lval / rval; break;
-                case POW_OP:
-                    if (rval < 0) ok = false;
-                    else {
-                        res = 1;
-                        for (long long i = 0; i < rval; ++i) res *= lval;
-                    }
-                    break;
-                case LE_OP:    res = (lval < rval) ? 1 : 0; break;
-                default: ok = false; break;
-            }
-            if (ok) {
-                exp->cont = 1;
-                exp->valor = static_cast<int>(res);
-                if (res >= INT32_MIN && res <= INT32_MAX) {
-                    emit(" movl $" + to_string(res) + ", %eax");
-                } else {
-                    emit(" movq $" + to_string(res) + ", %rax");
-                }
-                return 0;
-            }
-        }
+    if (exp->op == POW_OP && esLiteral(exp) && tryParseLong(constEval(exp), v)) {
+        return constante(v >= INT32_MIN && v <= INT32_MAX ? IrType::I32 : IrType::I64, v);
+    }
+    // el lado que necesita mas registros va primero: asi el otro resultado no
+    // queda vivo mientras tanto. sin llamadas ningun orden cambia el valor
+    int left, right;
+    registrosNecesarios(exp);
+    if (exp->right->registros > exp->left->registros && !exp->llamadas) {
+        right = exp->right->accept(this);
+        left = exp->left->accept(this);
+    } else {
+        left = exp->left->accept(this);
+        right = exp->right->accept(this);
     }
-    
-    
-    // Evaluar left
-    
-
-
-    exp->left->accept(this);
-    // Guardar resultado left
     Type::TType lt = exp->left->inferredType;
     Type::TType rt = exp->right->inferredType;
-    bool floatOp = (lt == Type::FLOAT) || (rt == Type::FLOAT);
-    if (floatOp) {
-        emit(" subq $16, %rsp"); // espacio para guardar xmm0
-        emit(" movdqu %xmm0, (%rsp)");
-        exp->right->accept(this); // right en xmm0
-        emit(" movdqu %xmm0, %xmm1");
-        emit(" movdqu (%rsp), %xmm0"); // left en xmm0
-        emit(" addq $16, %rsp");
-        switch (exp->op) {
-            case PLUS_OP: emit(" addss %xmm1, %xmm0"); break;
-            case MINUS_OP: emit(" subss %xmm1, %xmm0"); break;
-            case MUL_OP: emit(" mulss %xmm1, %xmm0"); break;
-            case DIV_OP: emit(" divss %xmm1, %xmm0"); break;
-            case LE_OP:
-                emit(" ucomiss %xmm1, %xmm0");
-                emit(" setb %al");
-                emit(" movzbq %al, %rax");
-                break;
-            default: break;
-        }
-        return 0;
+    IrOp op;
+    switch (exp->op) {
+        case PLUS_OP:  op = IR_ADD; break;
+        case MINUS_OP: op = IR_SUB; break;
+        case MUL_OP:   op = IR_MUL; break;
+        case DIV_OP:   op = IR_DIV; break;
+        case LE_OP:    op = IR_LT; break;
+        default:       return left; // pow no constante: queda el operando izquierdo
     }
 
-    emit(" pushq %rax");      // left en stack
-    exp->right->accept(this); // right en %rax
-    emit(" movq %rax, %rcx"); // right en rcx
-    emit(" popq %rax");       // left en rax
-
-    bool use32 = (lt == Type::INT || lt == Type::UINT) && (rt == Type::INT || rt == Type::UINT);
-    bool unsignedOp = (lt == Type::UINT || rt == Type::UINT);
-
-    switch (exp->op) {
-        case PLUS_OP:
-            emit((use32 ? " addl %ecx, %eax" : " addq %rcx, %rax"));
-            break;
-        case MINUS_OP:
-            emit((use32 ? " subl %ecx, %eax" : " subq %rcx, %rax"));
-            break;
-        case MUL_OP:
-            emit((use32 ? " imull %ecx, %eax" : " imulq %rcx, %rax"));
-            break;
-        case DIV_OP:
-            if (use32) {
-                emit(" cltd");
-                emit(" idivl %ecx");
-            } else {
-                emit(" cqto");
-                emit(" idivq %rcx");
-            }
-            break;
-        case LE_OP:
-            emit((use32 ? " cmpl %ecx, %eax" : " cmpq %rcx, %rax"));
-            emit(" movl $0, %eax");
-            emit(unsignedOp ? " setb %al" : " setl %al");
-            emit(" movzbq %al, %rax");
-            break;
-        default:
-            break;
+    IrType t;
+    if (lt == Type::FLOAT || rt == Type::FLOAT) {
+        t = IrType::F32; // un lado entero se convierte
+    } else {
+        bool use32 = (lt == Type::INT || lt == Type::UINT) && (rt == Type::INT || rt == Type::UINT);
+        bool unsignedOp = (lt == Type::UINT || rt == Type::UINT);
+        t = use32 ? (unsignedOp ? IrType::U32 : IrType::I32) : (unsignedOp ? IrType::U64 : IrType::I64);
     }
-    return 0;
+    left = convertir(left, t);
+    right = convertir(right, t);
+    int d = ir->newTemp(op == IR_LT ? IrType::BOOL : t == IrType::U64 ? IrType::I64 : t);
+    agregar(op, t, d, left, right);
+    return d;
 }
 
 int GenCodeVisitor::visit(TernaryExp* exp) {
     int label = labelcont++;
-    exp->condition->accept(this);
-    emit(" cmpq $0, %rax");
-    emit(" je ternary_else_" + to_string(label));
-    exp->thenExp->accept(this);
-    emit(" jmp ternary_end_" + to_string(label));
-    emit("ternary_else_" + to_string(label) + ":");
-    exp->elseExp->accept(this);
-    emit("ternary_end_" + to_string(label) + ":");
-    return 0;
+    IrType t = irTypeOf(exp->inferredType);
+    int res = ir->newTemp(t);
+    int cond = exp->condition->accept(this);
+    int thenB = nuevoBloque();
+    int elseB = nuevoBloque("ternary_else_", label);
+    int endB = nuevoBloque("ternary_end_", label);
+    bifurcar(cond, thenB, elseB);
+    empezarBloque(thenB);
+    agregar(IR_COPY, t, res, convertir(exp->thenExp->accept(this), t));
+    saltar(endB);
+    empezarBloque(elseB);
+    agregar(IR_COPY, t, res, convertir(exp->elseExp->accept(this), t));
+    empezarBloque(endB);
+    return res;
 }
 
 int GenCodeVisitor::visit(AssignStm* stm) {
     currentLine = stm->line;
-    stm->e->accept(this);
-    string vtype = typeEnv.check(stm->id) ? typeEnv.lookup(stm->id) : globalTypes[stm->id];
-    string store = movStore(vtype);
-    if (memoriaGlobal.count(stm->id)) {
-        if (isFloatType(vtype)) emit(" movss %xmm0, " + stm->id + "(%rip)");
-        else emit(store + (store == " movb " ? "%al" : (is32Bit(vtype) ? "%eax" : "%rax")) + ", " + stm->id + "(%rip)");
-    } else {
-        int off = env.lookup(stm->id);
-        if (isFloatType(vtype)) emit(" movss %xmm0, " + to_string(off) + "(%rbp)");
-        else emit(store + (store == " movb " ? "%al" : (is32Bit(vtype) ? "%eax" : "%rax")) + ", " + to_string(off) + "(%rbp)");
-    }
+    int value = stm->e->accept(this);
+    IrVar v;
+    if (variable(stm->id, v)) agregar(IR_STORE, v.type, -1, convertir(value, v.type)).var = v;
     if (currentVars.count(stm->id)) currentVars[stm->id].value = constEval(stm->e);
-    if (entornoFuncion && currentFrame.label != "none") snapshot("assign " + stm->id, stm->line);
+    if (entornoFuncion && currentFrame.label != "none") snapshot("assign " + names->name(stm->id), stm->line);
     return 0;
 }
 
 int GenCodeVisitor::visit(PrintStm* stm) {
     currentLine = stm->line;
-    stm->e->accept(this);
+    int value = stm->e->accept(this);
     // determinar tipo
     string t = "int";
-    if (auto num = dynamic_cast<NumberExp*>(stm->e)) t = Type::type_to_string(num->literalType);
-    else if (auto id = dynamic_cast<IdExp*>(stm->e)) t = typeEnv.check(id->value) ? typeEnv.lookup(id->value) : globalTypes[id->value];
+    if (auto num = nodeAs<NumberExp>(stm->e)) t = Type::type_to_string(num->literalType);
+    else if (auto id = nodeAs<IdExp>(stm->e)) {
+        const string* local = typeEnv.find(id->value);
+        t = local ? *local : findGlobalType(globalTypes, id->value);
+    }
     string fmt = "print_int";
     if (t == "unsigned int") fmt = "print_uint";
     else if (t == "long") fmt = "print_long";
     else if (t == "float") fmt = "print_float";
     else if (t == "bool") fmt = "print_bool";
 
-    if (t == "float") {
-        emit(" cvtss2sd %xmm0, %xmm0"); // promocionar a double para printf
-        emit(" movl $1, %eax");
-        emit(" leaq " + fmt + "(%rip), %rdi");
-    } else {
-        emit(" movq %rax, %rsi");
-        emit(" leaq " + fmt + "(%rip), %rdi");
-        emit(" movl $0, %eax");
-    }
-    emit(" call printf@PLT");
+    IrType pt = t == "float" ? IrType::F32 : IrType::I64;
+    agregar(IR_PRINT, pt, -1, convertir(value, pt)).name = fmt;
     if (entornoFuncion && currentFrame.label != "none") {
         snapshot("print", stm->line);
     }
@@ -513,20 +614,10 @@ int GenCodeVisitor::visit(Body* b) {
         for (size_t i = 0; i < dec->initializers.size() && varIt != dec->vars.end(); ++i, ++varIt) {
             Exp* init = dec->initializers[i];
             if (!init) continue;
-            const string& varName = *varIt;
-            string vtype = typeEnv.check(varName) ? typeEnv.lookup(varName) : findGlobalType(globalFrame, varName);
-            init->accept(this);
-            if (isFloatType(vtype)) {
-                if (memoriaGlobal.count(varName)) emit(" movss %xmm0, " + varName + "(%rip)");
-                else emit(" movss %xmm0, " + to_string(env.lookup(varName)) + "(%rbp)");
-            } else {
-                string store = movStore(vtype);
-                string reg = (store == " movb " ? "%al" : (is32Bit(vtype) ? "%eax" : "%rax"));
-                if (memoriaGlobal.count(varName))
-                    emit(store + reg + ", " + varName + "(%rip)");
-                else
-                    emit(store + reg + ", " + to_string(env.lookup(varName)) + "(%rbp)");
-            }
+            Symbol varName = *varIt;
+            int value = init->accept(this);
+            IrVar v;
+            if (variable(varName, v)) agregar(IR_STORE, v.type, -1, convertir(value, v.type)).var = v;
             if (currentVars.count(varName)) currentVars[varName].value = constEval(init);
         }
     }
@@ -541,10 +632,10 @@ int GenCodeVisitor::visit(IfStm* stm) {
 
     if (entornoFuncion && currentFrame.label != "none") snapshot("if", stm->line);
 
-    string cval = constEval(stm->condition);
+    // una condicion literal decide la rama ya (sus snapshots no se generan);
+    // si depende de variables, propagarConstantes descarta la rama muerta
     long long v;
-
-    if (tryParseLong(cval, v)) {
+    if (esLiteral(stm->condition) && tryParseLong(constEval(stm->condition), v)) {
         if (v != 0) {
             if (stm->then) stm->then->accept(this);
         } else {
@@ -552,39 +643,42 @@ int GenCodeVisitor::visit(IfStm* stm) {
         }
         return 0;
     }
-    else{
-        int label = labelcont++;
-        stm->condition->accept(this);
-        emit(" cmpq $0, %rax");
-        emit(" je else_" + to_string(label));
-        stm->then->accept(this);
-        emit(" jmp endif_" + to_string(label));
-        emit("else_" + to_string(label) + ":");
-        if (stm->els) stm->els->accept(this);
-        emit("endif_" + to_string(label) + ":");
-    }
+    int label = labelcont++;
+    int cond = stm->condition->accept(this);
+    int thenB = nuevoBloque();
+    int elseB = nuevoBloque("else_", label);
+    int endB = nuevoBloque("endif_", label);
+    bifurcar(cond, thenB, elseB);
+    empezarBloque(thenB);
+    if (stm->then) stm->then->accept(this);
+    saltar(endB);
+    empezarBloque(elseB);
+    if (stm->els) stm->els->accept(this);
+    empezarBloque(endB);
     return 0;
-    
 }
 
 int GenCodeVisitor::visit(WhileStm* stm) {
     currentLine = stm->line;
     if (entornoFuncion && currentFrame.label != "none") snapshot("while", stm->line);
     int label = labelcont++;
-    emit("while_" + to_string(label) + ":");
-    stm->condition->accept(this);
-    emit(" cmpq $0, %rax");
-    emit(" je endwhile_" + to_string(label));
+    int condB = nuevoBloque("while_", label);
+    int bodyB = nuevoBloque();
+    int endB = nuevoBloque("endwhile_", label);
+    empezarBloque(condB);
+    bifurcar(stm->condition->accept(this), bodyB, endB);
+    empezarBloque(bodyB);
     stm->b->accept(this);
-    emit(" jmp while_" + to_string(label));
-    emit("endwhile_" + to_string(label) + ":");
+    saltar(condB);
+    empezarBloque(endB);
     return 0;
 }
 
 int GenCodeVisitor::visit(ReturnStm* stm) {
     currentLine = stm->line;
-    if (stm->e) stm->e->accept(this);
-    emit(" jmp .end_" + nombreFuncion);
+    int value = stm->e ? stm->e->accept(this) : -1;
+    if (value >= 0 && tipoFuncion != "void") value = convertir(value, irTypeOf(tipoFuncion));
+    agregar(IR_RET, value >= 0 ? ir->temps[value] : IrType::I64, -1, value);
     if (entornoFuncion && currentFrame.label != "none") {
         snapshot("return", stm->line);
     }
@@ -598,16 +692,16 @@ int GenCodeVisitor::visit(ForStm* stm) {
     typeEnv.add_level();
     if (stm->init) stm->init->accept(this);
     int label = labelcont++;
-    emit("for_" + to_string(label) + ":");
-    if (stm->condition) {
-        stm->condition->accept(this);
-        emit(" cmpq $0, %rax");
-        emit(" je endfor_" + to_string(label));
-    }
+    int condB = nuevoBloque("for_", label);
+    int bodyB = nuevoBloque();
+    int endB = nuevoBloque("endfor_", label);
+    empezarBloque(condB);
+    if (stm->condition) bifurcar(stm->condition->accept(this), bodyB, endB);
+    empezarBloque(bodyB);
     if (stm->b) stm->b->accept(this);
     if (stm->step) stm->step->accept(this);
-    emit(" jmp for_" + to_string(label));
-    emit("endfor_" + to_string(label) + ":");
+    saltar(condB);
+    empezarBloque(endB);
     env.remove_level();
     typeEnv.remove_level();
     return 0;
@@ -622,21 +716,20 @@ int GenCodeVisitor::visit(FunDec* f) {
     typeEnv.add_level();
     offset = -8;
     nombreFuncion = f->nombre;
+    tipoFuncion = f->type;
     currentFrame = Frame{f->nombre, {}};
-
-    vector<string> argRegs = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
-    vector<string> argRegsXmm = {"%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5"};
+    ir->name = f->nombre;
 
     int funcLine = -1;
     if (f->cuerpo) {
         if (!f->cuerpo->declarations.empty()) funcLine = f->cuerpo->declarations.front()->line;
         else if (!f->cuerpo->StmList.empty()) funcLine = f->cuerpo->StmList.front()->line;
     }
-    currentLine = funcLine;
-    emit(".globl " + f->nombre, funcLine-1);
-    emit(f->nombre + ":", funcLine-1);
-    emit(" pushq %rbp", funcLine-1);
-    emit(" movq %rsp, %rbp", funcLine-1);
+    // el prologo y el guardado de parametros se asocian a la linea anterior al cuerpo
+    int prologLine = funcLine - 1 >= 0 ? funcLine - 1 : funcLine;
+    ir->prologLine = prologLine < -1 ? -2 : prologLine;
+    currentLine = prologLine;
+    empezarBloque(nuevoBloque());
 
     // Preasignar offsets de locales
     int funcOffset = offset;
@@ -649,66 +742,39 @@ int GenCodeVisitor::visit(FunDec* f) {
         if (misalign != 0) funcOffset -= (align - misalign);
         env.add_var(f->Pnombres[i], funcOffset);
         typeEnv.add_var(f->Pnombres[i], ptype);
-        FrameVar fv{f->Pnombres[i], funcOffset, ptype, "?"};
+        FrameVar fv{names->name(f->Pnombres[i]), funcOffset, ptype, "?", f->Pnombres[i]};
         currentFrame.vars.push_back(fv);
-        currentVars[fv.name] = fv;
+        currentVars[fv.sym] = fv;
         funcOffset -= sz;
     }
     usedVars.clear();
     if (f->cuerpo) {
-        markUsedVarsInBody(f->cuerpo);
-
-        for (auto &dec : f->cuerpo->declarations) {
-            for (auto init : dec->initializers) {
-                if (init) markUsedVars(init);
-            }
-        }
+        UsedVarsCollector{{}, usedVars}.walk(f->cuerpo);
 
         funcOffset = preAsignarOffsets(f->cuerpo, funcOffset);
     }
-    int totalStack = -funcOffset - 8;
-    int align16 = totalStack % 16;
-    if (align16 != 0) totalStack += (16 - align16);
-    if (totalStack > 0) {
-        emit(" subq $" + to_string(totalStack) + ", %rsp", funcLine-1);
-        offset = -8 - totalStack;
-    }
+    ir->frameBottom = funcOffset; // los temporales van debajo
 
-    // Guardar parametros en sus slots
+    // Guardar parametros en sus slots: los registros de entrada se leen antes que nada
     int floatIdx = 0, intIdx = 0;
-    vector<string> argRegs32 = {"%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d"};
-    vector<string> argRegs8  = {"%dil", "%sil", "%dl", "%cl", "%r8b", "%r9b"};
     for (int i = 0; i < (int)f->Pnombres.size(); ++i) {
-        string ptype = typeEnv.lookup(f->Pnombres[i]);
-        int destOff = env.lookup(f->Pnombres[i]);
-        if (isFloatType(ptype)) {
-            if (floatIdx < (int)argRegsXmm.size())
-                emit(" movss " + argRegsXmm[floatIdx] + ", " + to_string(destOff) + "(%rbp)", funcLine-1);
-            floatIdx++;
-        } else {
-            string movInstr = movStore(ptype);
-            string srcReg;
-            if (movInstr == " movb ")
-                srcReg = (intIdx < (int)argRegs8.size()) ? argRegs8[intIdx] : "%dil";
-            else if (movInstr == " movl ")
-                srcReg = (intIdx < (int)argRegs32.size()) ? argRegs32[intIdx] : "%edi";
-            else
-                srcReg = (intIdx < (int)argRegs.size()) ? argRegs[intIdx] : "%rdi";
-
-            emit(movInstr + srcReg + ", " + to_string(destOff) + "(%rbp)", funcLine-1);
-            intIdx++;
+        IrVar v;
+        variable(f->Pnombres[i], v);
+        int& idx = irIsFloat(v.type) ? floatIdx : intIdx;
+        if (idx < 6) {
+            int d = ir->newTemp(v.type);
+            agregar(IR_ARG, v.type, d).imm = idx;
+            agregar(IR_STORE, v.type, -1, d).var = v;
         }
+        idx++;
     }
+    currentLine = funcLine;
 
     // snapshot inicial: prolog (linea -1 y/o justo antes de la declaracion) para cualquier funcion
     snapshot("prolog", funcLine > 0 ? funcLine - 1 : -1);
 
     if (f->cuerpo) f->cuerpo->accept(this);
 
-    emit(".end_" + f->nombre + ":");
-    emit("leave");
-    emit("ret");
-
     entornoFuncion = false;
     env.remove_level();
     typeEnv.remove_level();
@@ -718,126 +784,89 @@ int GenCodeVisitor::visit(FunDec* f) {
 }
 
 int GenCodeVisitor::visit(FcallExp* exp) {
-    vector<string> argRegs = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
-    vector<string> argRegsXmm = {"%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5"};
-    int intIdx = 0, floatIdx = 0;
-    for (auto* a : exp->argumentos) {
-        a->accept(this);
-        Type::TType at = a->inferredType;
-        if (at == Type::FLOAT) {
-            if (floatIdx < (int)argRegsXmm.size())
-                emit(" movaps %xmm0, " + argRegsXmm[floatIdx]);
-            floatIdx++;
-        } else {
-            if (intIdx < (int)argRegs.size())
-                emit(" movq %rax, " + argRegs[intIdx]);
-            intIdx++;
-        }
-    }
-    if (floatIdx > 0) emit(" movl $" + to_string(floatIdx) + ", %eax"); else emit(" movl $0, %eax");
-    emit(" call " + exp->nombre);
-    return 0;
+    // argumentos de mas pesado a mas liviano si ninguno llama a otra funcion
+    vector<int> args(exp->argumentos.size());
+    vector<size_t> orden(args.size());
+    bool puros = true;
+    for (size_t i = 0; i < orden.size(); ++i) {
+        orden[i] = i;
+        registrosNecesarios(exp->argumentos[i]);
+        puros = puros && !exp->argumentos[i]->llamadas;
+    }
+    if (puros) {
+        stable_sort(orden.begin(), orden.end(), [&](size_t a, size_t b) {
+            return exp->argumentos[a]->registros > exp->argumentos[b]->registros;
+        });
+    }
+    for (size_t i : orden) args[i] = exp->argumentos[i]->accept(this);
+    int d = ir->newTemp(irTypeOf(exp->inferredType));
+    IrInst& call = agregar(IR_CALL, ir->temps[d], d);
+    call.name = exp->nombre;
+    call.args = std::move(args);
+    return d;
 }
 
 void GenCodeVisitor::snapshot(const string& label, int line) {
-    if (currentFrame.label == "none") return;
-    out << "# SNAPIDX " << snapshotCounter << " " << label;
-    if (line > 0) out << " line " << line;
-    out << "\n";
+    if (currentFrame.label == "none" || !ir) return;
     vector<FrameVar> vars;
     for (auto &fv : currentFrame.vars) {
-        auto it = currentVars.find(fv.name);
+        auto it = currentVars.find(fv.sym);
         if (it != currentVars.end()) fv.value = it->second.value;
         vars.push_back(fv);
     }
     sort(vars.begin(), vars.end(), [](const FrameVar& a, const FrameVar& b){ return a.offset > b.offset; });
-    snapshots.push_back(Snapshot{label, vars, line, snapshotCounter, nombreFuncion.empty() ? "global" : nombreFuncion});
+    IrInst& snap = agregar(IR_SNAP, IrType::I64);
+    snap.imm = snapshotCounter;
+    snap.name = label;
+    snap.line = line;
+    ir->snapshots.push_back(Snapshot{label, vars, line, snapshotCounter, nombreFuncion.empty() ? "global" : nombreFuncion});
     snapshotCounter++;
 }
 
 string GenCodeVisitor::constEval(Exp* e) {
-    if (auto num = dynamic_cast<NumberExp*>(e)) {
-        return to_string(num->value);
-    }
-    if (auto b = dynamic_cast<BoolExp*>(e)) {
-        return to_string(b->valor);
-    }
-    if (auto id = dynamic_cast<IdExp*>(e)) {
+    switch (e->kind) {
+    case NUMBER_EXP:
+        return to_string(static_cast<NumberExp*>(e)->value);
+    case BOOL_EXP:
+        return to_string(static_cast<BoolExp*>(e)->valor);
+    case ID_EXP: {
         // Evaluar IdExp si tenemos un valor conocido en currentVars (propagacion de constantes simple)
-        auto it = currentVars.find(id->value);
+        auto it = currentVars.find(static_cast<IdExp*>(e)->value);
         if (it != currentVars.end()) return it->second.value;
         return "?";
     }
-    if (auto bin = dynamic_cast<BinaryExp*>(e)) {
+    case BINARY_EXP: {
+        auto bin = static_cast<BinaryExp*>(e);
         string lstr = constEval(bin->left);
         string rstr = constEval(bin->right);
         long long lval, rval;
         if (!tryParseLong(lstr, lval) || !tryParseLong(rstr, rval)) return "?";
-        long long res = 0;
+        // aritmetica de 64 bits que da la vuelta, como la del programa (y como
+        // plegar en ssa.cpp): el desborde con signo no puede tirar el compilador
+        uint64_t x = (uint64_t)lval, y = (uint64_t)rval, res = 0;
         switch (bin->op) {
-            case PLUS_OP:  res = lval + rval; break;
-            case MINUS_OP: res = lval - rval; break;
-            case MUL_OP:   res = lval * rval; break;
-            case DIV_OP:   if (rval == 0) return "?"; res = lval / rval; break;
+            case PLUS_OP:  res = x + y; break;
+            case MINUS_OP: res = x - y; break;
+            case MUL_OP:   res = x * y; break;
+            case DIV_OP:
+                if (rval == 0 || (lval == INT64_MIN && rval == -1)) return "?";
+                res = (uint64_t)(lval / rval);
+                break;
             case POW_OP:
-                res = 1; for (long long i = 0; i < rval; ++i) res *= lval; break;
+                // por cuadrados: un exponente enorme no deja colgado al compilador
+                res = 1;
+                for (uint64_t b = x, n = rval > 0 ? y : 0; n; n >>= 1, b *= b) {
+                    if (n & 1) res *= b;
+                }
+                break;
             case LE_OP:    res = (lval < rval) ? 1 : 0; break;
             default: return "?";
         }
-        return to_string(res);
-    }
-    if (dynamic_cast<FcallExp*>(e)) return "call";
-    return "?";
-}
-
-void GenCodeVisitor::markUsedVars(Exp* e) {
-    if (auto id = dynamic_cast<IdExp*>(e)) {
-        usedVars.insert(id->value);
-    } else if (auto bin = dynamic_cast<BinaryExp*>(e)) {
-        markUsedVars(bin->left);
-        markUsedVars(bin->right);
-    } else if (auto tern = dynamic_cast<TernaryExp*>(e)) {
-        markUsedVars(tern->condition);
-        markUsedVars(tern->thenExp);
-        markUsedVars(tern->elseExp);
-    } else if (auto fcall = dynamic_cast<FcallExp*>(e)) {
-        for (auto arg : fcall->argumentos)
-            markUsedVars(arg);
-    }
-}
-
-void GenCodeVisitor::markUsedVarsInBody(Body* b) {
-    for (auto stm : b->StmList) {
-        if (auto assign = dynamic_cast<AssignStm*>(stm)) {
-            markUsedVars(assign->e);
-        } else if (auto print = dynamic_cast<PrintStm*>(stm)) {
-            markUsedVars(print->e);
-        } else if (auto ifs = dynamic_cast<IfStm*>(stm)) {
-            markUsedVars(ifs->condition);
-            if (ifs->then) markUsedVarsInBody(ifs->then);
-            if (ifs->els) markUsedVarsInBody(ifs->els);
-        } else if (auto wh = dynamic_cast<WhileStm*>(stm)) {
-            markUsedVars(wh->condition);
-            if (wh->b) markUsedVarsInBody(wh->b);
-        } else if (auto ret = dynamic_cast<ReturnStm*>(stm)) {
-            if (ret->e) markUsedVars(ret->e);
-        } else if (auto fs = dynamic_cast<ForStm*>(stm)) {
-            if (fs->condition) markUsedVars(fs->condition);
-            // fs->step es una Stm* (p.ej. AssignStm). manejarlo según su tipo:
-            if (fs->step) {
-                if (auto s_assign = dynamic_cast<AssignStm*>(fs->step)) {
-                    markUsedVars(s_assign->e);
-                } else if (auto s_print = dynamic_cast<PrintStm*>(fs->step)) {
-                    markUsedVars(s_print->e);
-                } else if (auto s_ret = dynamic_cast<ReturnStm*>(fs->step)) {
-                    if (s_ret->e) markUsedVars(s_ret->e);
-                } else if (auto s_if = dynamic_cast<IfStm*>(fs->step)) {
-                    markUsedVars(s_if->condition);
-                    if (s_if->then) markUsedVarsInBody(s_if->then);
-                    if (s_if->els) markUsedVarsInBody(s_if->els);
-                } // añadir más casos si tu lenguaje permite otros tipos de step
-            }
-            if (fs->b) markUsedVarsInBody(fs->b);
-        }
+        return to_string((long long)res);
+    }
+    case FCALL_EXP:
+        return "call";
+    default:
+        return "?";
     }
 }
\ No newline at end of file
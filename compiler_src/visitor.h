@@ -7,12 +7,15 @@
 #include <vector>
 #include <unordered_map>
 #include <string>
-#include <fstream>
+#include <ostream>
 #include <map>
 #include <algorithm>
 #include <set>
+#include <unordered_set>
+#include <cstdint>
 // Env
 #include "environment.h"
+#include "peephole.h"
 
 using namespace std;
 
@@ -32,6 +35,12 @@ class FcallExp;
 class ReturnStm;
 class FunDec;
 class ForStm;
+class ThreadPool;
+struct IrFunction;
+struct IrInst;
+struct IrVar;
+enum class IrType : uint8_t;
+enum IrOp : uint8_t;
 
 struct FrameVar {
     // variable con nombre, offset en stack, tipo y valor simbolico
@@ -39,6 +48,7 @@ struct FrameVar {
     int offset;
     string type;
     string value;
+    Symbol sym = -1; // simbolo internado de name (-1 en frames sinteticos)
 };
 
 struct Frame {
@@ -56,6 +66,27 @@ struct Snapshot {
     string func;
 };
 
+struct CodeLine {
+    // linea de asm de una funcion aun sin enlazar: etiquetas y snapshots
+    // llevan numeros locales a la funcion y se renumeran al escribirla
+    enum Kind { TEXT, LABEL, SNAP };
+    Kind kind;
+    string text;   // TEXT: instruccion; LABEL: texto antes del numero; SNAP: etiqueta
+    string suffix; // LABEL: texto despues del numero (":" en definiciones)
+    int num;       // LABEL: etiqueta local; SNAP: indice local del snapshot
+    int line;      // linea fuente (asmByLine o snapshot); < 0 sin linea propia
+};
+
+struct FunctionCode {
+    // resultado reubicable de generar un FunDec: se puede enlazar en otra
+    // posicion del .s (otros contadores, lineas desplazadas) sin regenerarlo
+    vector<CodeLine> lines;
+    vector<Snapshot> snapshots; // idx locales, mismo orden que las lineas SNAP
+    int labelCount = 0;
+    int endLine = -1;           // currentLine al terminar (lo emitido despues cae ahi)
+    EstadisticasPeephole peephole; // lo que reescribio optimizarPeephole (no se guarda en la sesion)
+};
+
 // Interfaz de Visitor
 class Visitor {
 public:
@@ -87,27 +118,45 @@ public:
 class GenCodeVisitor : public Visitor {
 private:
     ostream& out;
-    string stackPath;
-    set<string> usedVars;  
-    void markUsedVars(Exp* e);
-    void markUsedVarsInBody(Body* b);
+    ostream* stackOut;  // json de snapshots (nullptr: no se genera)
+    ostream* asmMapOut; // json linea -> asm (nullptr: no se genera)
+    unordered_set<Symbol> usedVars;
+    const Interner* names = nullptr; // del programa en generacion (iniciarPrograma)
+    IrFunction* ir = nullptr;    // funcion en compilacion; las visitas bajan a su ir
+    int bloque = -1;             // bloque actual de ir
+    vector<int> ordenBloques;    // bloques en el orden en que se empezaron
 
 public:
-    GenCodeVisitor(ostream& out, const string& stackPath = "") : out(out), stackPath(stackPath) {}
+    GenCodeVisitor(ostream& out, ostream* stackOut = nullptr, ostream* asmMapOut = nullptr)
+        : out(out), stackOut(stackOut), asmMapOut(asmMapOut) {}
 
     int generar(Program* program);
+    // generacion por funcion: encabezado y globales, luego cada FunDec en
+    // cuanto esta verificada, y al final el cierre del asm y los json
+    void iniciarPrograma(Program* program);
+    void generarFuncion(FunDec* fd);
+    void terminarPrograma();
+    // generarFuncion en dos pasos: compilar a un FunctionCode reubicable y
+    // enlazarlo al final del .s con sus lineas desplazadas lineDelta
+    FunctionCode compilarFuncion(FunDec* fd);
+    void enlazarFuncion(const FunctionCode& code, int lineDelta = 0);
+    // compilarFuncion de cada fd repartida en el pool; el resultado queda en
+    // el orden de fds y se enlaza igual que si se hubiera generado en serie
+    vector<FunctionCode> compilarFunciones(const vector<FunDec*>& fds, ThreadPool& pool);
     Environment<int> env;                       // offsets
     Environment<string> typeEnv;                // tipos (locals)
-    unordered_map<string, bool> memoriaGlobal;  // globals: nombre -> bool
-    unordered_map<string, string> globalTypes;   // tipos de globales
+    unordered_map<Symbol, bool> memoriaGlobal;  // globals: simbolo -> bool
+    vector<Symbol> globalOrder;                  // globals en orden de declaracion
+    unordered_map<Symbol, string> globalTypes;   // tipos de globales
     int    offset        = -8;                   // offset actual en stack
     int    labelcont     = 0;                    // contador para labels unicos
     bool   entornoFuncion = false;               // estamos generando dentro de funcion
     string nombreFuncion;
+    string tipoFuncion;                          // tipo de retorno declarado
     Frame  globalFrame{"globals"};
     Frame  currentFrame{"none"};
     vector<Snapshot> snapshots;                  // capturas de stack para el front
-    map<string, FrameVar> currentVars;           // valores simbolicos actuales
+    unordered_map<Symbol, FrameVar> currentVars; // valores simbolicos actuales
     int snapshotCounter = 0;
     map<int, vector<string>> asmByLine;          // linea -> instrucciones
     int currentLine = -1;                        // linea fuente actual para emit
@@ -136,11 +185,23 @@ public:
 
 private:
     int preAsignarOffsets(Body* body, int startOffset);          // asigna offsets antes de generar
-    void saveStack();                                            // guarda snapshots de stack en json
-    void saveAsmMap();                                           // guarda asm por linea en stackpath+.asm.json
+    void cerrarAsm();                                            // seccion final y cierre del ambito global
+    void saveStack();                                            // escribe snapshots de stack en stackOut
+    void saveAsmMap();                                           // escribe asm por linea en asmMapOut
     void emit(const string& instr, int lineOverride = -1);       // escribe asm y lo asocia a linea actual
     void snapshot(const string& label, int line = -1);           // captura estado del frame para el front
     string constEval(Exp* e);                                    // eval simbolica simple para valores en stack
+
+    // construccion del ir (ver ir.h)
+    IrInst& agregar(IrOp op, IrType type, int dst = -1, int a = -1, int b = -1); // instruccion al final del bloque actual
+    int constante(IrType t, int64_t v);
+    int convertir(int temp, IrType to);                          // cvt si cambia entre entero y float o extiende un int
+    int nuevoBloque(const string& label = "", int num = -1);
+    void empezarBloque(int b);                                   // el bloque actual cae en b si no termino
+    bool terminado() const;
+    void saltar(int b);
+    void bifurcar(int cond, int siCierto, int siFalso);
+    bool variable(Symbol s, IrVar& v);                           // false: local sin slot
 };
 
 #endif // VISITOR_H
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "x86_backend.h"
+#include "regalloc.h"
+
+using namespace std;
+
+namespace {
+
+const char* const ARG_REGS[] = {"%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9"};
+const char* const ARG_XMMS[] = {"%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5"};
+
+// cada temporal esta en el registro o el slot que le dio asignarRegistros;
+// las operaciones pasan por %rax/%rcx (o %xmm0/%xmm1) salvo las copias,
+// cargas y constantes que pueden ir directo al registro destino
+class Emitter {
+private:
+    const IrFunction& f;
+    AsignacionRegistros ra;
+    FunctionCode code;
+    vector<int> blockLabel;        // numero de etiqueta de cada bloque (-1 sin etiqueta)
+    vector<bool> targeted;         // algun salto explicito llega al bloque
+
+    // operando de 64 bits (o xmm) del temporal t
+    string loc(int t) const {
+        if (ra.reg[t] != R_NINGUNO) return nombreRegistro(ra.reg[t]);
+        return to_string(ra.slot[t]) + "(%rbp)";
+    }
+    // mismo lugar leido con el ancho dado (en memoria es la misma direccion)
+    string loc(int t, int bits) const {
+        if (ra.reg[t] != R_NINGUNO) return nombreRegistro(ra.reg[t], bits);
+        return loc(t);
+    }
+    bool enRegistro(int t) const { return ra.reg[t] != R_NINGUNO; }
+
+    string mem(const IrVar& v) const {
+        if (v.global) return f.names->name(v.sym) + "(%rip)";
+        return to_string(v.offset) + "(%rbp)";
+    }
+
+    string blockName(int b) const {
+        const IrBlock& blk = f.blocks[b];
+        return blk.label.empty() ? "bb_" : blk.label;
+    }
+
+    void text(const string& s, int line) {
+        code.lines.push_back(CodeLine{CodeLine::TEXT, s, "", 0, line});
+    }
+
+    void jump(const string& instr, int b, int line) {
+        code.lines.push_back(CodeLine{CodeLine::LABEL, instr + blockName(b), "", blockLabel[b], line});
+    }
+
+    bool isFloat(int t) const { return irIsFloat(f.temps[t]); }
+
+    void load(int t, const char* reg, const char* xmm, int line) {
+        if (isFloat(t)) text(string(" movss ") + loc(t) + ", " + xmm, line);
+        else text(" movq " + loc(t) + ", " + reg, line);
+    }
+
+    // el resultado quedo en %rax o %xmm0 segun la clase de dst
+    void storeResult(int dst, int line) {
+        if (isFloat(dst)) text(" movss %xmm0, " + loc(dst), line);
+        else text(" movq %rax, " + loc(dst), line);
+    }
+
+    void emitInst(const IrInst& in, int next);
+    void emitBinary(const IrInst& in);
+
+public:
+    explicit Emitter(const IrFunction& f) : f(f), ra(asignarRegistros(f)) {}
+    FunctionCode run();
+};
+
+void Emitter::emitBinary(const IrInst& in) {
+    int line = in.line;
+    if (irIsFloat(in.type)) {
+        string b = loc(in.b);
+        text(" movss " + loc(in.a) + ", %xmm0", line);
+        switch (in.op) {
+            case IR_ADD: text(" addss " + b + ", %xmm0", line); break;
+            case IR_SUB: text(" subss " + b + ", %xmm0", line); break;
+            case IR_MUL: text(" mulss " + b + ", %xmm0", line); break;
+            case IR_DIV: text(" divss " + b + ", %xmm0", line); break;
+            case IR_LT:
+                text(" ucomiss " + b + ", %xmm0", line);
+                text(" setb %al", line);
+                text(" movzbq %al, %rax", line);
+                break;
+            default: break;
+        }
+        storeResult(in.dst, line);
+        return;
+    }
+    bool use32 = irIs32(in.type);
+    string b = use32 ? loc(in.b, 32) : loc(in.b);
+    string acc = use32 ? "%eax" : "%rax";
+    char w = use32 ? 'l' : 'q';
+    text(" movq " + loc(in.a) + ", %rax", line);
+    switch (in.op) {
+        case IR_ADD: text(string(" add") + w + " " + b + ", " + acc, line); break;
+        case IR_SUB: text(string(" sub") + w + " " + b + ", " + acc, line); break;
+        case IR_MUL: text(string(" imul") + w + " " + b + ", " + acc, line); break;
+        case IR_DIV:
+            text(use32 ? " cltd" : " cqto", line);
+            text(string(" idiv") + w + " " + b, line);
+            break;
+        case IR_LT:
+            text(string(" cmp") + w + " " + b + ", " + acc, line);
+            text(irIsUnsigned(in.type) ? " setb %al" : " setl %al", line);
+            text(" movzbq %al, %rax", line);
+            break;
+        default: break;
+    }
+    storeResult(in.dst, line);
+}
+
+void Emitter::emitInst(const IrInst& in, int next) {
+    int line = in.line;
+    switch (in.op) {
+        case IR_CONST:
+            if (irIsFloat(in.type) && enRegistro(in.dst)) {
+                text(" movl $" + to_string((uint32_t)in.imm) + ", %eax", line);
+                text(" movd %eax, " + loc(in.dst), line);
+            } else if (irIsFloat(in.type)) {
+                text(" movl $" + to_string((uint32_t)in.imm) + ", " + loc(in.dst), line);
+            } else if (enRegistro(in.dst)) { // movl extiende con ceros, como en el resto
+                text(irIs32(in.type) || in.type == IrType::BOOL
+                         ? " movl $" + to_string(in.imm) + ", " + loc(in.dst, 32)
+                         : " movq $" + to_string(in.imm) + ", " + loc(in.dst), line);
+            } else {
+                text(irIs32(in.type) || in.type == IrType::BOOL
+                         ? " movl $" + to_string(in.imm) + ", %eax"
+                         : " movq $" + to_string(in.imm) + ", %rax", line);
+                storeResult(in.dst, line);
+            }
+            break;
+        case IR_LOAD:
+            if (enRegistro(in.dst)) {
+                if (irIsFloat(in.var.type)) text(" movss " + mem(in.var) + ", " + loc(in.dst), line);
+                else if (in.var.type == IrType::BOOL) text(" movzbq " + mem(in.var) + ", " + loc(in.dst), line);
+                else if (irIs32(in.var.type)) text(" movl " + mem(in.var) + ", " + loc(in.dst, 32), line);
+                else text(" movq " + mem(in.var) + ", " + loc(in.dst), line);
+                break;
+            }
+            if (irIsFloat(in.var.type)) text(" movss " + mem(in.var) + ", %xmm0", line);
+            else if (in.var.type == IrType::BOOL) text(" movzbq " + mem(in.var) + ", %rax", line);
+            else if (irIs32(in.var.type)) text(" movl " + mem(in.var) + ", %eax", line);
+            else text(" movq " + mem(in.var) + ", %rax", line);
+            storeResult(in.dst, line);
+            break;
+        case IR_STORE:
+            if (enRegistro(in.a)) {
+                if (irIsFloat(in.var.type)) text(" movss " + loc(in.a) + ", " + mem(in.var), line);
+                else if (in.var.type == IrType::BOOL) text(" movb " + loc(in.a, 8) + ", " + mem(in.var), line);
+                else if (irIs32(in.var.type)) text(" movl " + loc(in.a, 32) + ", " + mem(in.var), line);
+                else text(" movq " + loc(in.a) + ", " + mem(in.var), line);
+                break;
+            }
+            load(in.a, "%rax", "%xmm0", line);
+            if (irIsFloat(in.var.type)) text(" movss %xmm0, " + mem(in.var), line);
+            else if (in.var.type == IrType::BOOL) text(" movb %al, " + mem(in.var), line);
+            else if (irIs32(in.var.type)) text(" movl %eax, " + mem(in.var), line);
+            else text(" movq %rax, " + mem(in.var), line);
+            break;
+        case IR_ARG:
+            if (isFloat(in.dst)) text(string(" movss ") + ARG_XMMS[in.imm] + ", " + loc(in.dst), line);
+            else text(string(" movq ") + ARG_REGS[in.imm] + ", " + loc(in.dst), line);
+            break;
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+        case IR_DIV:
+        case IR_LT:
+            emitBinary(in);
+            break;
+        case IR_CVT: {
+            IrType from = f.temps[in.a];
+            if (irIsFloat(from) && irIsFloat(in.type)) {
+                load(in.a, "%rax", "%xmm0", line);
+            } else if (!irIsFloat(from) && !irIsFloat(in.type)) { // truncar como al guardar en memoria
+                load(in.a, "%rax", "%xmm0", line);
+                if (in.type == IrType::BOOL && from != IrType::BOOL) text(" movzbq %al, %rax", line);
+                else if (irIs32(in.type) && !irIs32(from) && from != IrType::BOOL) text(" movl %eax, %eax", line);
+                else if (from == IrType::I32 && !irIs32(in.type) && in.type != IrType::BOOL) text(" movslq %eax, %rax", line);
+            } else if (irIsFloat(in.type)) {
+                text(" movq " + loc(in.a) + ", %rax", line);
+                text(from == IrType::I32 ? " cvtsi2ssl %eax, %xmm0" : " cvtsi2ssq %rax, %xmm0", line);
+            } else {
+                text(" movss " + loc(in.a) + ", %xmm0", line);
+                text(irIs32(in.type) ? " cvttss2sil %xmm0, %eax" : " cvttss2siq %xmm0, %rax", line);
+            }
+            storeResult(in.dst, line);
+            break;
+        }
+        case IR_COPY:
+            if (loc(in.a) == loc(in.dst)) break;
+            if (enRegistro(in.a) || enRegistro(in.dst)) {
+                text((isFloat(in.dst) ? " movss " : " movq ") + loc(in.a) + ", " + loc(in.dst), line);
+                break;
+            }
+            load(in.a, "%rax", "%xmm0", line);
+            storeResult(in.dst, line);
+            break;
+        case IR_CALL: {
+            int intIdx = 0, floatIdx = 0;
+            for (int arg : in.args) {
+                if (isFloat(arg)) {
+                    if (floatIdx < 6) text(" movss " + loc(arg) + ", " + ARG_XMMS[floatIdx], line);
+                    floatIdx++;
+                } else {
+                    if (intIdx < 6) text(" movq " + loc(arg) + ", " + ARG_REGS[intIdx], line);
+                    intIdx++;
+                }
+            }
+            text(" movl $" + to_string(floatIdx) + ", %eax", line);
+            text(" call " + in.name, line);
+            if (in.dst >= 0) storeResult(in.dst, line);
+            break;
+        }
+        case IR_PRINT:
+            if (isFloat(in.a)) {
+                text(" movss " + loc(in.a) + ", %xmm0", line);
+                text(" cvtss2sd %xmm0, %xmm0", line); // printf recibe double
+                text(" movl $1, %eax", line);
+            } else {
+                text(" movq " + loc(in.a) + ", %rsi", line);
+                text(" movl $0, %eax", line);
+            }
+            text(" leaq " + in.name + "(%rip), %rdi", line);
+            text(" call printf@PLT", line);
+            break;
+        case IR_SNAP:
+            code.lines.push_back(CodeLine{CodeLine::SNAP, in.name, "", (int)in.imm, line});
+            break;
+        case IR_PHI: // destruirSsa los reemplaza por copias antes de llegar aca
+            break;
+        case IR_JMP:
+            if (in.target != next) jump(" jmp ", in.target, line);
+            break;
+        case IR_BR:
+            text(" cmpq $0, " + loc(in.a), line);
+            if (in.other == next) {
+                jump(" jne ", in.target, line);
+            } else {
+                jump(" je ", in.other, line);
+                if (in.target != next) jump(" jmp ", in.target, line);
+            }
+            break;
+        case IR_RET:
+            if (in.a >= 0) load(in.a, "%rax", "%xmm0", line);
+            text(" jmp .end_" + f.name, line);
+            break;
+    }
+}
+
+FunctionCode Emitter::run() {
+    // que bloques necesitan etiqueta: los que reciben un salto explicito
+    size_t nb = f.blocks.size();
+    targeted.assign(nb, false);
+    for (size_t i = 0; i < nb; ++i) {
+        const IrBlock& b = f.blocks[i];
+        if (b.insts.empty()) continue;
+        const IrInst& t = b.insts.back();
+        int next = (int)i + 1;
+        if (t.op == IR_JMP && t.target != next) targeted[t.target] = true;
+        if (t.op == IR_BR) {
+            if (t.other == next) targeted[t.target] = true;
+            else {
+                targeted[t.other] = true;
+                if (t.target != next) targeted[t.target] = true;
+            }
+        }
+    }
+    int labels = f.labelCount;
+    blockLabel.assign(nb, -1);
+    for (size_t i = 0; i < nb; ++i) {
+        if (!targeted[i]) continue;
+        blockLabel[i] = f.blocks[i].label.empty() ? labels++ : f.blocks[i].labelNum;
+    }
+
+    int pl = f.prologLine;
+    text(".globl " + f.name, pl);
+    text(f.name + ":", pl);
+    text(" pushq %rbp", pl);
+    text(" movq %rsp, %rbp", pl);
+    if (ra.frame > 0) text(" subq $" + to_string(ra.frame) + ", %rsp", pl);
+    for (auto& g : ra.guardados) text(string(" movq ") + nombreRegistro(g.first) + ", " + to_string(g.second) + "(%rbp)", pl);
+
+    for (size_t i = 0; i < nb; ++i) {
+        const IrBlock& b = f.blocks[i];
+        if (targeted[i]) {
+            code.lines.push_back(CodeLine{CodeLine::LABEL, blockName((int)i), ":", blockLabel[i], b.line});
+        }
+        for (const IrInst& in : b.insts) emitInst(in, (int)i + 1);
+    }
+
+    text(".end_" + f.name + ":", f.endLine);
+    for (auto& g : ra.guardados) {
+        text(" movq " + to_string(g.second) + "(%rbp), " + nombreRegistro(g.first), f.endLine);
+    }
+    text("leave", f.endLine);
+    text("ret", f.endLine);
+
+    code.snapshots = f.snapshots;
+    code.labelCount = labels;
+    code.endLine = f.endLine;
+    return code;
+}
+
+} // namespace
+
+FunctionCode emitirX86(const IrFunction& f) {
+    return Emitter(f).run();
+}
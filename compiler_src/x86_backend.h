@@ -0,0 +1,16 @@
+#ifndef X86_BACKEND_H
+#define X86_BACKEND_H
+// traduccion de un IrFunction a asm x86-64 (AT&T), con los temporales donde
+// los ubica asignarRegistros (regalloc.h). el resultado es un
+// FunctionCode reubicable: las etiquetas de bloque usan numeros locales y
+// cada instruccion lleva la linea fuente de la instruccion ir que la genero,
+// asi enlazarFuncion arma asmByLine igual que antes.
+
+#include "ir.h"
+#include "visitor.h"
+
+using namespace std;
+
+FunctionCode emitirX86(const IrFunction& f);
+
+#endif // X86_BACKEND_H